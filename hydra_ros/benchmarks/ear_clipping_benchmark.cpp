@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <chrono>
+#include <random>
+#include <sstream>
+
+#include "hydra_ros/utils/ear_clipping.h"
+
+DEFINE_string(num_vertices, "100,1000,10000", "comma separated polygon sizes");
+DEFINE_double(min_radius, 0.5, "minimum vertex distance from the polygon center");
+DEFINE_int32(num_trials, 10, "number of timed calls per benchmark");
+DEFINE_int32(seed, 0, "random seed for the synthetic polygons");
+
+namespace hydra {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Func>
+double timeCalls(const Func& func) {
+  double ms = 0.0;
+  for (int i = 0; i < FLAGS_num_trials; ++i) {
+    const auto start = Clock::now();
+    func();
+    const auto end = Clock::now();
+    ms += std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  return ms / FLAGS_num_trials;
+}
+
+//! Star-shaped polygon with random radii (roughly half the vertices end up reflex)
+std::vector<Vertex> makePolygon(size_t num_vertices, std::mt19937& rng) {
+  std::uniform_real_distribution<double> radius(FLAGS_min_radius, 1.0);
+  std::vector<Vertex> vertices;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const double theta = 2.0 * M_PI * i / num_vertices;
+    const double r = radius(rng);
+    vertices.push_back({Eigen::Vector2d(r * std::cos(theta), r * std::sin(theta)), i});
+  }
+
+  return vertices;
+}
+
+void runBenchmark(size_t num_vertices, std::mt19937& rng) {
+  const auto vertices = makePolygon(num_vertices, rng);
+  size_t num_faces = 0;
+  const auto min_angle = timeCalls([&]() {
+    Polygon polygon(vertices);
+    num_faces = polygon.triangulate().size();
+  });
+  LOG(INFO) << "[" << num_vertices << " vertices] min angle ears: " << min_angle
+            << " ms/call (" << num_faces << " faces)";
+
+  const auto first_ear = timeCalls([&]() {
+    Polygon polygon(vertices);
+    num_faces = polygon.triangulate(true).size();
+  });
+  LOG(INFO) << "[" << num_vertices << " vertices] first ears: " << first_ear
+            << " ms/call (" << num_faces << " faces)";
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::mt19937 rng(FLAGS_seed);
+  std::stringstream ss(FLAGS_num_vertices);
+  std::string num_vertices;
+  while (std::getline(ss, num_vertices, ',')) {
+    hydra::runBenchmark(std::stoul(num_vertices), rng);
+  }
+
+  return 0;
+}
@@ -0,0 +1,323 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <random>
+
+#include "hydra_ros/utils/occupancy_publisher.h"
+
+DEFINE_double(extent_m, 500.0, "side length of the synthetic map");
+DEFINE_int32(height_blocks, 1, "number of blocks along z in the synthetic map");
+DEFINE_double(voxel_size, 0.25, "voxel size of the synthetic map");
+DEFINE_int32(voxels_per_side, 8, "voxels per block side of the synthetic map");
+DEFINE_double(observed_fraction, 0.8, "fraction of voxels that are observed");
+DEFINE_double(occupied_fraction, 0.1, "fraction of observed voxels that are occupied");
+DEFINE_double(updated_fraction, 0.01, "fraction of blocks updated per incremental call");
+DEFINE_int32(num_slices, 3, "number of slices to collapse into the grid");
+DEFINE_int32(num_threads, 4, "number of rasterization threads");
+DEFINE_int32(num_trials, 10, "number of timed calls per benchmark");
+DEFINE_int32(seed, 0, "random seed for the synthetic map");
+
+namespace {
+
+std::atomic<size_t> num_allocations(0);
+
+void* allocate(std::size_t size) {
+  ++num_allocations;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment) {
+  ++num_allocations;
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const auto align = static_cast<std::size_t>(alignment);
+  const auto padded = ((size == 0 ? 1 : size) + align - 1) / align * align;
+  return std::aligned_alloc(align, padded);
+}
+
+void* checked(void* ptr) {
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+}  // namespace
+
+// count every heap allocation (through any form of new) so we can report allocations
+// per call. Aligned allocations come from aligned_alloc, so every form frees with free
+void* operator new(std::size_t size) { return checked(allocate(size)); }
+
+void* operator new[](std::size_t size) { return checked(allocate(size)); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return checked(allocate(size, alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return checked(allocate(size, alignment));
+}
+
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return allocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+namespace hydra {
+
+using Clock = std::chrono::steady_clock;
+
+struct Timing {
+  double ms = 0.0;
+  double allocations = 0.0;
+};
+
+std::ostream& operator<<(std::ostream& out, const Timing& timing) {
+  return out << timing.ms << " ms/call, " << timing.allocations << " allocations/call";
+}
+
+void fillVoxel(std::mt19937& rng, TsdfVoxel& voxel) {
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  voxel.weight = dist(rng) < FLAGS_observed_fraction ? 1.0f : 0.0f;
+  voxel.distance = dist(rng) < FLAGS_occupied_fraction ? 0.0f : 1.0f;
+}
+
+void fillVoxel(std::mt19937& rng, places::GvdVoxel& voxel) {
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  voxel.observed = dist(rng) < FLAGS_observed_fraction;
+  voxel.distance = dist(rng) < FLAGS_occupied_fraction ? 0.0f : 1.0f;
+}
+
+template <typename BlockT>
+std::shared_ptr<spatial_hash::VoxelLayer<BlockT>> makeLayer(std::mt19937& rng) {
+  auto layer = std::make_shared<spatial_hash::VoxelLayer<BlockT>>(
+      FLAGS_voxel_size, FLAGS_voxels_per_side);
+  const int num_blocks = std::ceil(FLAGS_extent_m / layer->blockSize());
+  for (int x = 0; x < num_blocks; ++x) {
+    for (int y = 0; y < num_blocks; ++y) {
+      for (int z = 0; z < FLAGS_height_blocks; ++z) {
+        auto block = layer->allocateBlockPtr(BlockIndex(x, y, z));
+        for (size_t i = 0; i < block->numVoxels(); ++i) {
+          fillVoxel(rng, block->getVoxel(i));
+        }
+      }
+    }
+  }
+
+  return layer;
+}
+
+template <typename Func>
+Timing timeCalls(const Func& func) {
+  Timing timing;
+  for (int i = 0; i < FLAGS_num_trials; ++i) {
+    const size_t allocations_before = num_allocations;
+    const auto start = Clock::now();
+    func();
+    const auto end = Clock::now();
+    timing.ms += std::chrono::duration<double, std::milli>(end - start).count();
+    timing.allocations += num_allocations - allocations_before;
+  }
+
+  timing.ms /= FLAGS_num_trials;
+  timing.allocations /= FLAGS_num_trials;
+  return timing;
+}
+
+//! Marks a random subset of blocks as updated for each incremental call
+template <typename BlockT>
+class BlockUpdater {
+ public:
+  BlockUpdater(std::mt19937& rng, spatial_hash::VoxelLayer<BlockT>& layer) : rng_(rng) {
+    for (auto& block : layer) {
+      block.updated = false;
+      blocks_.push_back(&block);
+    }
+
+    num_updated = FLAGS_updated_fraction * blocks_.size();
+  }
+
+  void next() {
+    for (auto block : updated_) {
+      block->updated = false;
+    }
+
+    updated_.clear();
+    std::sample(
+        blocks_.begin(), blocks_.end(), std::back_inserter(updated_), num_updated, rng_);
+    for (auto block : updated_) {
+      block->updated = true;
+    }
+  }
+
+  size_t num_updated;
+
+ private:
+  std::mt19937& rng_;
+  std::vector<BlockT*> blocks_;
+  std::vector<BlockT*> updated_;
+};
+
+template <typename BlockT>
+void runBenchmark(const std::string& name, std::mt19937& rng) {
+  auto layer = makeLayer<BlockT>(rng);
+
+  OccupancyPublisher::Config config;
+  config.num_slices = FLAGS_num_slices;
+  config.num_threads = FLAGS_num_threads;
+  config.use_relative_height = false;
+  config.slice_height = FLAGS_voxel_size;
+
+  // rasterizing the layer directly (what publishTsdf and publishGvd do)
+  const Eigen::Isometry3d world_T_sensor = Eigen::Isometry3d::Identity();
+  IncrementalOccupancyGrid grid(config);
+  const auto full = timeCalls([&]() {
+    grid.reset();
+    grid.update(world_T_sensor, *layer);
+  });
+
+  const auto& msg = grid.grid();
+  LOG(INFO) << "[" << name << "] grid: " << msg.info.width << " x " << msg.info.height
+            << " cells (" << layer->numBlocks() << " blocks)";
+  LOG(INFO) << "[" << name << "] full rebuild: " << full;
+
+  BlockUpdater<BlockT> updater(rng, *layer);
+  const auto incremental = timeCalls([&]() {
+    updater.next();
+    grid.update(world_T_sensor, *layer);
+  });
+  LOG(INFO) << "[" << name << "] incremental (" << updater.num_updated
+            << " blocks): " << incremental;
+
+  // collating into the compact layer and rasterizing that instead
+  OccupancyLayer collated(layer->voxel_size, layer->voxels_per_side);
+  std::vector<BlockIndex> indices;
+  for (auto& block : *layer) {
+    block.updated = true;
+  }
+
+  collate(config, *layer, collated, indices);
+  for (auto& block : *layer) {
+    block.updated = false;
+  }
+
+  const auto collate_timing = timeCalls([&]() {
+    updater.next();
+    collate(config, *layer, collated, indices);
+  });
+  LOG(INFO) << "[" << name << "] collate (" << updater.num_updated
+            << " blocks): " << collate_timing;
+
+  IncrementalOccupancyGrid collated_grid(config);
+  collated_grid.update(world_T_sensor, collated);
+  const auto collated_incremental = timeCalls([&]() {
+    updater.next();
+    collate(config, *layer, collated, indices);
+    collated_grid.update(world_T_sensor, collated);
+  });
+  LOG(INFO) << "[" << name << "] collate + incremental (" << updater.num_updated
+            << " blocks): " << collated_incremental;
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::mt19937 rng(FLAGS_seed);
+  hydra::runBenchmark<hydra::TsdfBlock>("tsdf", rng);
+  hydra::runBenchmark<hydra::places::GvdBlock>("gvd", rng);
+  return 0;
+}
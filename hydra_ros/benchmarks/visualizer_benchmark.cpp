@@ -0,0 +1,458 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <hydra/common/semantic_color_map.h>
+#include <ros/master.h>
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <spark_dsg/node_attributes.h>
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <typeinfo>
+
+#include "hydra_ros/visualizer/basis_point_plugin.h"
+#include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
+#include "hydra_ros/visualizer/footprint_plugin.h"
+#include "hydra_ros/visualizer/mesh_plugin.h"
+#include "hydra_ros/visualizer/region_plugin.h"
+#include "hydra_ros/visualizer/visualizer_utilities.h"
+
+DEFINE_string(num_nodes, "10000,100000", "comma separated graph sizes to benchmark");
+DEFINE_int32(num_agents, 2, "number of dynamic agent layers");
+DEFINE_int32(mesh_vertices_per_node, 4, "mesh vertices per static node");
+DEFINE_int32(mesh_connections, 8, "mesh vertices attached to each mesh place");
+DEFINE_int32(num_trials, 5, "number of timed calls per benchmark");
+DEFINE_int32(seed, 0, "random seed for the synthetic graphs");
+// the visualizer and plugins advertise their topics and dynamic_reconfigure servers
+// on construction, which blocks until a ROS master answers
+DEFINE_bool(with_ros,
+            true,
+            "also time full redraws and plugins if a ROS master is reachable");
+
+namespace hydra {
+
+using Clock = std::chrono::steady_clock;
+using visualization_msgs::Marker;
+using visualization_msgs::MarkerArray;
+
+struct Timing {
+  double ms = 0.0;
+  size_t bytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, const Timing& timing) {
+  return out << timing.ms << " ms/call, " << timing.bytes / 1024.0 << " KiB";
+}
+
+//! Time func over several trials, reporting the serialized size of what it returns
+template <typename Func>
+Timing timeCalls(const Func& func) {
+  Timing timing;
+  for (int i = 0; i < FLAGS_num_trials; ++i) {
+    const auto start = Clock::now();
+    const auto msg = func();
+    const auto end = Clock::now();
+    timing.ms += std::chrono::duration<double, std::milli>(end - start).count();
+    timing.bytes = ros::serialization::serializationLength(msg);
+  }
+
+  timing.ms /= FLAGS_num_trials;
+  return timing;
+}
+
+std::vector<size_t> parseSizes(const std::string& sizes) {
+  std::vector<size_t> parsed;
+  std::stringstream ss(sizes);
+  std::string size;
+  while (std::getline(ss, size, ',')) {
+    parsed.push_back(std::stoul(size));
+  }
+
+  return parsed;
+}
+
+Color randomColor(std::mt19937& rng) {
+  std::uniform_int_distribution<int> dist(0, 255);
+  return Color(dist(rng), dist(rng), dist(rng));
+}
+
+/**
+ * @brief Build a graph with roughly num_nodes nodes spread over every layer
+ *
+ * Half of the nodes are places on a grid with 4-connected edges, the rest are mesh
+ * places, objects, rooms, a building and agent poses. Objects hang off the nearest
+ * place, places off their room and rooms off the building.
+ */
+DynamicSceneGraph::Ptr makeGraph(size_t num_nodes, std::mt19937& rng) {
+  auto graph = std::make_shared<DynamicSceneGraph>();
+  const size_t num_places = num_nodes / 2;
+  const size_t num_mesh_places = num_nodes / 5;
+  const size_t num_objects = num_nodes / 5;
+  const size_t num_rooms = std::max<size_t>(num_nodes / 1000, 1);
+  const size_t num_agent_poses = num_nodes - num_places - num_mesh_places -
+                                 num_objects - num_rooms - 1;
+
+  const size_t side = std::ceil(std::sqrt(num_places));
+  const size_t room_side = std::ceil(std::sqrt(num_rooms));
+  std::uniform_real_distribution<double> coord(0.0, side);
+  std::uniform_real_distribution<double> height(0.0, 3.0);
+  const auto random_pos = [&]() {
+    return Eigen::Vector3d(coord(rng), coord(rng), height(rng));
+  };
+
+  const auto room_for = [&](double x, double y) {
+    const size_t rx = std::min<size_t>(x * room_side / side, room_side - 1);
+    const size_t ry = std::min<size_t>(y * room_side / side, room_side - 1);
+    return std::min(rx * room_side + ry, num_rooms - 1);
+  };
+
+  auto building = std::make_unique<SemanticNodeAttributes>();
+  building->position = Eigen::Vector3d(side / 2.0, side / 2.0, 0.0);
+  graph->emplaceNode(DsgLayers::BUILDINGS, NodeSymbol('B', 0), std::move(building));
+  for (size_t i = 0; i < num_rooms; ++i) {
+    auto attrs = std::make_unique<RoomNodeAttributes>();
+    const double step = static_cast<double>(side) / room_side;
+    attrs->position = Eigen::Vector3d(
+        (i / room_side + 0.5) * step, (i % room_side + 0.5) * step, 0.0);
+    attrs->color = randomColor(rng);
+    graph->emplaceNode(DsgLayers::ROOMS, NodeSymbol('R', i), std::move(attrs));
+    graph->insertEdge(NodeSymbol('B', 0), NodeSymbol('R', i));
+  }
+
+  for (size_t i = 0; i < num_places; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>(height(rng), 2);
+    const double x = i / side;
+    const double y = i % side;
+    attrs->position = Eigen::Vector3d(x, y, 1.0);
+    graph->emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), std::move(attrs));
+    graph->insertEdge(NodeSymbol('R', room_for(x, y)), NodeSymbol('p', i));
+    if (i % side > 0) {
+      graph->insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+
+    if (i >= side) {
+      graph->insertEdge(NodeSymbol('p', i - side), NodeSymbol('p', i));
+    }
+  }
+
+  const size_t num_vertices = FLAGS_mesh_vertices_per_node * num_nodes;
+  auto mesh = std::make_shared<Mesh>();
+  mesh->resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh->setPos(i, random_pos().cast<float>());
+  }
+
+  graph->setMesh(mesh);
+
+  std::uniform_int_distribution<size_t> vertex(0, num_vertices - 1);
+  for (size_t i = 0; i < num_mesh_places; ++i) {
+    auto attrs = std::make_unique<Place2dNodeAttributes>();
+    attrs->position = random_pos();
+    attrs->color = randomColor(rng);
+    for (int j = 0; j < FLAGS_mesh_connections; ++j) {
+      attrs->pcl_mesh_connections.push_back(vertex(rng));
+    }
+
+    graph->emplaceNode(DsgLayers::MESH_PLACES, NodeSymbol('t', i), std::move(attrs));
+  }
+
+  for (size_t i = 0; i < num_objects; ++i) {
+    auto attrs = std::make_unique<ObjectNodeAttributes>();
+    attrs->position = random_pos();
+    attrs->color = randomColor(rng);
+    attrs->bounding_box = BoundingBox(Eigen::Vector3f::Constant(0.5f),
+                                      attrs->position.cast<float>());
+    const size_t x = std::min<size_t>(attrs->position.x(), side - 1);
+    const size_t y = std::min<size_t>(attrs->position.y(), side - 1);
+    const size_t place = std::min(x * side + y, num_places - 1);
+    graph->emplaceNode(DsgLayers::OBJECTS, NodeSymbol('O', i), std::move(attrs));
+    graph->insertEdge(NodeSymbol('p', place), NodeSymbol('O', i));
+  }
+
+  // each agent follows its own random walk
+  const size_t num_agents = std::max(FLAGS_num_agents, 1);
+  std::normal_distribution<double> step(0.0, 0.5);
+  std::vector<Eigen::Vector3d> agent_positions;
+  for (size_t i = 0; i < num_agents; ++i) {
+    agent_positions.push_back(random_pos());
+  }
+
+  for (size_t i = 0; i < num_agent_poses; ++i) {
+    auto& pos = agent_positions[i % num_agents];
+    pos += Eigen::Vector3d(step(rng), step(rng), 0.0);
+    auto attrs = std::make_unique<AgentNodeAttributes>(
+        Eigen::Quaterniond::Identity(), pos, 0);
+    graph->emplaceNode(DsgLayers::AGENTS,
+                       'a' + i % num_agents,
+                       std::chrono::nanoseconds(i / num_agents),
+                       std::move(attrs));
+  }
+
+  return graph;
+}
+
+LayerConfig makeLayerConfig() {
+  auto config = LayerConfig::__getDefault__();
+  config.visualize = true;
+  return config;
+}
+
+DynamicLayerConfig makeDynamicLayerConfig() {
+  auto config = DynamicLayerConfig::__getDefault__();
+  config.visualize = true;
+  return config;
+}
+
+Color nodeColor(const SceneGraphNode& node) {
+  return node.attributes<SemanticNodeAttributes>().color;
+}
+
+void benchmarkUtilities(const std::string& name, const DynamicSceneGraph& graph) {
+  std_msgs::Header header;
+  header.frame_id = "world";
+  const auto viz_config = VisualizerConfig::__getDefault__();
+
+  std::map<LayerId, LayerConfig> configs;
+  for (const auto& id_layer_pair : graph.layers()) {
+    configs[id_layer_pair.first] = makeLayerConfig();
+  }
+
+  std::map<LayerId, DynamicLayerConfig> dynamic_configs;
+  for (const auto& id_layers_pair : graph.dynamicLayers()) {
+    dynamic_configs[id_layers_pair.first] = makeDynamicLayerConfig();
+  }
+
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    const auto& config = configs.at(layer_id);
+    const auto prefix = "[" + name + "] layer " + std::to_string(layer_id) + " (" +
+                        std::to_string(layer->numNodes()) + " nodes, " +
+                        std::to_string(layer->numEdges()) + " edges) ";
+
+    const auto nodes = timeCalls([&]() {
+      return makeCentroidMarkers(
+          header, config, *layer, viz_config, "nodes", nodeColor);
+    });
+    LOG(INFO) << prefix << "centroids: " << nodes;
+
+    MarkerBuffers buffers;
+    const auto pooled = timeCalls([&]() {
+      auto marker = makeCentroidMarkers(
+          header, config, *layer, viz_config, "nodes", nodeColor, {}, &buffers);
+      // measure the size before the storage goes back to the pool
+      MarkerArray msg;
+      msg.markers.push_back(std::move(marker));
+      const auto copy = msg;
+      buffers.release(msg);
+      return copy;
+    });
+    LOG(INFO) << prefix << "centroids (pooled buffers): " << pooled;
+
+    const auto cloud = timeCalls([&]() {
+      return makeCentroidCloud(header, config, *layer, viz_config, nodeColor);
+    });
+    LOG(INFO) << prefix << "centroid cloud: " << cloud;
+
+    const auto edges = timeCalls([&]() {
+      return makeLayerEdgeMarkers(
+          header, config, *layer, viz_config, Color(0, 0, 0), "edges");
+    });
+    LOG(INFO) << prefix << "edges: " << edges;
+
+    const auto compact_edges = timeCalls([&]() {
+      return makeCompactLayerEdgeMarkers(
+          header, config, *layer, viz_config, Color(0, 0, 0), "edges");
+    });
+    LOG(INFO) << prefix << "compact edges: " << compact_edges;
+
+    const auto labels = timeCalls([&]() {
+      MarkerArray msg;
+      for (const auto& id_node_pair : layer->nodes()) {
+        msg.markers.push_back(makeTextMarker(
+            header, config, *id_node_pair.second, viz_config, "labels"));
+      }
+
+      return msg;
+    });
+    LOG(INFO) << prefix << "labels: " << labels;
+
+    if (layer_id == DsgLayers::OBJECTS) {
+      const auto bboxes = timeCalls([&]() {
+        return makeLayerWireframeBoundingBoxes(
+            header, config, *layer, viz_config, "bboxes", nodeColor);
+      });
+      LOG(INFO) << prefix << "bounding boxes: " << bboxes;
+    }
+
+    if (layer_id == DsgLayers::MESH_PLACES) {
+      const auto mesh_edges = timeCalls([&]() {
+        return makeMeshEdgesMarker(
+            header, config, viz_config, graph, *layer, "mesh_edges");
+      });
+      LOG(INFO) << prefix << "mesh edges: " << mesh_edges;
+    }
+  }
+
+  const auto interlayer = timeCalls([&]() {
+    return makeGraphEdgeMarkers(header, graph, configs, viz_config, "interlayer");
+  });
+  LOG(INFO) << "[" << name << "] interlayer edges (" << graph.interlayer_edges().size()
+            << "): " << interlayer;
+
+  for (const auto& [layer_id, layers] : graph.dynamicLayers()) {
+    const auto& config = dynamic_configs.at(layer_id);
+    for (const auto& [prefix, layer] : layers) {
+      const auto name_prefix = "[" + name + "] agent " + std::string(1, prefix) + " (" +
+                               std::to_string(layer->numNodes()) + " nodes) ";
+      const auto nodes = timeCalls([&]() {
+        return makeDynamicCentroidMarkers(
+            header, config, *layer, viz_config, Color(255, 0, 0), "agent", 0);
+      });
+      LOG(INFO) << name_prefix << "centroids: " << nodes;
+
+      const auto edges = timeCalls([&]() {
+        return makeDynamicEdgeMarkers(
+            header, config, *layer, viz_config, Color(255, 0, 0), "agent", 0);
+      });
+      LOG(INFO) << name_prefix << "edges: " << edges;
+    }
+  }
+
+  const auto dynamic_interlayer = timeCalls([&]() {
+    return makeDynamicGraphEdgeMarkers(
+        header, graph, configs, dynamic_configs, viz_config, "dynamic_interlayer");
+  });
+  LOG(INFO) << "[" << name << "] dynamic interlayer edges: " << dynamic_interlayer;
+}
+
+//! Exposes the draw step of the visualizer without the publish and redraw gating
+class BenchmarkVisualizer : public DynamicSceneGraphVisualizer {
+ public:
+  explicit BenchmarkVisualizer(const ros::NodeHandle& nh)
+      : DynamicSceneGraphVisualizer(nh) {}
+
+  MarkerArray draw(bool redraw_all) {
+    std_msgs::Header header;
+    header.stamp = ros::Time::now();
+    header.frame_id = visualizer_frame_;
+
+    redraw_all_ = redraw_all;
+    MarkerArray msg;
+    redrawImpl(header, msg);
+    redraw_all_ = false;
+    return msg;
+  }
+
+  const ConfigManager& configs() const { return *config_manager_; }
+};
+
+void benchmarkVisualizer(const std::string& name,
+                         const DynamicSceneGraph::Ptr& graph,
+                         BenchmarkVisualizer& visualizer,
+                         const std::list<DsgVisualizerPlugin::Ptr>& plugins) {
+  visualizer.setGraph(graph);
+  const auto full = timeCalls([&]() { return visualizer.draw(true); });
+  LOG(INFO) << "[" << name << "] full redraw: " << full;
+
+  const auto cached = timeCalls([&]() { return visualizer.draw(false); });
+  LOG(INFO) << "[" << name << "] unchanged redraw: " << cached;
+
+  std_msgs::Header header;
+  header.stamp = ros::Time::now();
+  header.frame_id = "world";
+  for (const auto& plugin : plugins) {
+    const auto timing = timeCalls([&]() {
+      plugin->draw(visualizer.configs(), header, *graph);
+      return MarkerArray();
+    });
+    LOG(INFO) << "[" << name << "] plugin " << typeid(*plugin).name() << ": "
+              << timing.ms << " ms/call";
+  }
+}
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  std::unique_ptr<hydra::BenchmarkVisualizer> visualizer;
+  std::list<hydra::DsgVisualizerPlugin::Ptr> plugins;
+  bool use_ros = FLAGS_with_ros;
+  if (use_ros) {
+    ros::init(argc, argv, "visualizer_benchmark", ros::init_options::NoSigintHandler);
+    use_ros = ros::master::check();
+    LOG_IF(WARNING, !use_ros)
+        << "No ROS master reachable: skipping full redraw and plugin timings (start "
+           "roscore to include them)";
+  }
+
+  if (use_ros) {
+    // publishers without subscribers never serialize, so publishing doesn't skew the
+    // timings
+    ros::NodeHandle nh("~");
+    for (const auto layer : hydra::DynamicSceneGraph().layer_ids) {
+      nh.setParam("config/layer" + std::to_string(layer) + "/visualize", true);
+    }
+
+    visualizer = std::make_unique<hydra::BenchmarkVisualizer>(nh);
+    plugins.push_back(std::make_shared<hydra::MeshPlugin>(
+        hydra::MeshPlugin::Config(), nh, "mesh"));
+    plugins.push_back(std::make_shared<hydra::FootprintPlugin>(
+        hydra::FootprintPlugin::Config(), nh, "footprints"));
+    plugins.push_back(std::make_shared<hydra::RegionPlugin>(
+        hydra::RegionPlugin::Config(), nh, "regions"));
+    plugins.push_back(std::make_shared<hydra::BasisPointPlugin>(
+        hydra::BasisPointPlugin::Config(), nh, "basis_points"));
+  }
+
+  std::mt19937 rng(FLAGS_seed);
+  for (const auto num_nodes : hydra::parseSizes(FLAGS_num_nodes)) {
+    const auto graph = hydra::makeGraph(num_nodes, rng);
+    const auto name = std::to_string(graph->numNodes()) + " nodes";
+    hydra::benchmarkUtilities(name, *graph);
+    if (visualizer) {
+      hydra::benchmarkVisualizer(name, graph, *visualizer, plugins);
+    }
+  }
+
+  return 0;
+}
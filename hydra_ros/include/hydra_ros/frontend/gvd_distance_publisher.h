@@ -0,0 +1,141 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/frontend/gvd_place_extractor.h>
+#include <hydra/places/gvd_voxel.h>
+#include <hydra_msgs/FloatGrid.h>
+#include <ros/ros.h>
+
+#include <atomic>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief 2D grid of the minimum GVD distance over a height band, where only the block
+ * columns that changed (or were added or removed) since the last update are recomputed
+ */
+class GvdDistanceGrid {
+ public:
+  struct Config {
+    bool use_relative_height = true;
+    double slice_height = 0.0;
+    size_t num_slices = 1;
+  } const config;
+
+  explicit GvdDistanceGrid(const Config& config);
+
+  /**
+   * @brief Update the grid from any changed blocks in the layer
+   * @returns number of block columns that were recomputed
+   */
+  size_t update(const Eigen::Isometry3d& world_T_sensor, const places::GvdLayer& gvd);
+
+  //! Drop all grid state so that the next update rebuilds everything
+  void reset();
+
+  //! Copy a region of the grid into the message
+  void fillMsg(const GridRegion& region, hydra_msgs::FloatGrid& msg) const;
+
+  //! Region covering the whole grid
+  GridRegion bounds() const;
+
+  //! Regions of the grid that changed during the last update
+  const std::vector<GridRegion>& changedRegions() const { return regions_; }
+
+  //! Whether the grid was reallocated or cleared since the last call to clearResized
+  bool resized() const { return resized_; }
+
+  void clearResized() { resized_ = false; }
+
+  const std::vector<float>& distances() const { return distances_; }
+
+ private:
+  void reserve(const GridRegion& cells);
+
+  void fillColumn(const places::GvdLayer& gvd, const BlockIndex& column, bool clear);
+
+  float voxel_size_;
+  int voxels_per_side_;
+  //! global voxel z-index of the lowest slice
+  int64_t slice_index_;
+  //! global voxel index of the lower left cell of the grid
+  Eigen::Vector2i origin_;
+  Eigen::Vector2i dims_;
+  std::vector<float> distances_;
+  BlockColumnTracker columns_;
+  std::vector<GridRegion> regions_;
+  bool resized_;
+};
+
+class GvdDistancePublisher : public GvdPlaceExtractor::Sink {
+ public:
+  struct Config {
+    std::string ns = "~gvd";
+    GvdDistanceGrid::Config extraction;
+    //! Minimum time between full grids, with only the changed region published as
+    //! an update in between (0 only sends full grids on start, resize or subscribe)
+    double full_grid_period_s = 0.0;
+  } const config;
+
+  explicit GvdDistancePublisher(const Config& config);
+
+  virtual ~GvdDistancePublisher() = default;
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3f& world_T_sensor,
+            const places::GvdLayer& gvd,
+            const places::GraphExtractorInterface* extractor) const override;
+
+ private:
+  ros::NodeHandle nh_;
+  ros::Publisher pub_;
+  ros::Publisher update_pub_;
+  std::unique_ptr<GvdDistanceGrid> grid_;
+  mutable std::atomic<bool> send_full_grid_;
+  mutable uint64_t last_full_grid_ns_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<GvdPlaceExtractor::Sink,
+                                     GvdDistancePublisher,
+                                     Config>("GvdDistancePublisher");
+};
+
+void declare_config(GvdDistanceGrid::Config& config);
+void declare_config(GvdDistancePublisher::Config& config);
+
+}  // namespace hydra
@@ -44,6 +44,8 @@ class BowSubscriber;
 
 struct HydraRosConfig {
   bool enable_frontend_output = true;
+  //! serve batched raycasts against a snapshot of the TSDF (copies updated blocks)
+  bool enable_raycast_service = false;
   RosInputModule::Config input;
 };
 
@@ -0,0 +1,149 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/reconstruction/reconstruction_module.h>
+#include <hydra_msgs/FloatGrid.h>
+#include <ros/ros.h>
+
+#include <atomic>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief Persistent 2.5D map of ground height, step height and slope computed from the
+ * TSDF. Only block columns that changed are recomputed, and columns that leave the
+ * TSDF keep their last values. Cells of a recomputed column that no longer have ground
+ * revert to unknown (NaN).
+ */
+class ElevationMap {
+ public:
+  struct Config {
+    //! Minimum TSDF weight for a voxel to count as observed
+    double min_observation_weight = 1.0e-6;
+  } const config;
+
+  explicit ElevationMap(const Config& config);
+
+  /**
+   * @brief Recompute all block columns that have updated or new blocks
+   * @returns number of block columns that were recomputed
+   */
+  size_t update(const TsdfLayer& layer);
+
+  //! Copy every layer of a region of the map into the message
+  void fillMsg(const GridRegion& region, hydra_msgs::FloatGrid& msg) const;
+
+  //! Region covering the whole map
+  GridRegion bounds() const;
+
+  //! Regions of the map that changed during the last update
+  const std::vector<GridRegion>& changedRegions() const { return regions_; }
+
+  //! Whether the map was reallocated since the last call to clearResized
+  bool resized() const { return resized_; }
+
+  void clearResized() { resized_ = false; }
+
+  float voxelSize() const { return voxel_size_; }
+
+  const std::vector<float>& ground() const { return ground_; }
+
+  const std::vector<float>& step() const { return step_; }
+
+  const std::vector<float>& slope() const { return slope_; }
+
+ private:
+  void reserve(const GridRegion& cells);
+
+  void updateColumn(const TsdfLayer& layer,
+                    const BlockIndex& column,
+                    int min_block_z,
+                    int max_block_z);
+
+  void updateDerived(const GridRegion& region);
+
+  float voxel_size_;
+  int voxels_per_side_;
+  //! global voxel index of the lower left cell of the map
+  Eigen::Vector2i origin_;
+  Eigen::Vector2i dims_;
+  std::vector<float> ground_;
+  std::vector<float> step_;
+  std::vector<float> slope_;
+  BlockColumnTracker columns_;
+  std::vector<GridRegion> regions_;
+  bool resized_;
+};
+
+class ElevationPublisher : public ReconstructionModule::Sink {
+ public:
+  struct Config {
+    std::string ns = "~elevation";
+    ElevationMap::Config map;
+    //! Minimum time between full maps (0 only sends full maps on start, resize or
+    //! subscribe). The changed region is published as an update after every call
+    double full_map_period_s = 0.0;
+  } const config;
+
+  explicit ElevationPublisher(const Config& config);
+
+  virtual ~ElevationPublisher() = default;
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3d& world_T_sensor,
+            const TsdfLayer& tsdf,
+            const ReconstructionOutput& msg) const override;
+
+ private:
+  ros::NodeHandle nh_;
+  ros::Publisher pub_;
+  ros::Publisher update_pub_;
+  std::unique_ptr<ElevationMap> map_;
+  mutable std::atomic<bool> send_full_map_;
+  mutable uint64_t last_full_map_ns_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<ReconstructionModule::Sink,
+                                     ElevationPublisher,
+                                     Config>("ElevationPublisher");
+};
+
+void declare_config(ElevationMap::Config& config);
+void declare_config(ElevationPublisher::Config& config);
+
+}  // namespace hydra
@@ -0,0 +1,137 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/reconstruction/reconstruction_module.h>
+#include <hydra_msgs/RaycastTsdf.h>
+#include <ros/ros.h>
+
+#include <mutex>
+
+namespace hydra {
+
+/**
+ * @brief Immutable copy of a TSDF layer that can be queried from any thread.
+ *
+ * Unchanged blocks are shared between consecutive snapshots, so making a new snapshot
+ * only copies the blocks that were updated since the last one.
+ */
+class TsdfSnapshot {
+ public:
+  using Ptr = std::shared_ptr<const TsdfSnapshot>;
+
+  TsdfSnapshot(float voxel_size, size_t voxels_per_side);
+
+  static Ptr update(const Ptr& prev, const TsdfLayer& layer);
+
+  const TsdfBlock* getBlock(const BlockIndex& index) const;
+
+  const TsdfVoxel* getVoxel(const GlobalIndex& index) const;
+
+  const float voxel_size;
+  const size_t voxels_per_side;
+
+ private:
+  spatial_hash::BlockIndexMap<std::shared_ptr<const TsdfBlock>> blocks_;
+};
+
+struct RayResult {
+  //! distance to the first occupied voxel along the ray or -1 if there was no hit
+  double hit_distance = -1.0;
+  //! number of unobserved voxels traversed before the hit or the end of the ray
+  size_t num_unknown = 0;
+};
+
+class TsdfRaycaster {
+ public:
+  struct Config {
+    //! voxels below this weight are unknown
+    double min_observation_weight = 1.0e-6;
+    //! voxels with a distance below this are occupied
+    double surface_distance = 0.0;
+    //! rays longer than this are cut off after this distance
+    double max_range = 50.0;
+    size_t num_threads = 4;
+  } const config;
+
+  explicit TsdfRaycaster(const Config& config);
+
+  //! Cast a ray (clamped to the max range), where invalid rays never hit anything
+  RayResult cast(const TsdfSnapshot& tsdf,
+                 const Eigen::Vector3d& origin,
+                 const Eigen::Vector3d& endpoint) const;
+
+  std::vector<RayResult> castAll(const TsdfSnapshot& tsdf,
+                                 const std::vector<Eigen::Vector3d>& origins,
+                                 const std::vector<Eigen::Vector3d>& endpoints) const;
+};
+
+class TsdfRaycastServer : public ReconstructionModule::Sink {
+ public:
+  struct Config {
+    std::string ns = "~";
+    TsdfRaycaster::Config raycaster;
+  } const config;
+
+  explicit TsdfRaycastServer(const Config& config);
+
+  virtual ~TsdfRaycastServer() = default;
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3d& world_T_sensor,
+            const TsdfLayer& tsdf,
+            const ReconstructionOutput& msg) const override;
+
+ private:
+  bool handleRaycast(hydra_msgs::RaycastTsdf::Request& req,
+                     hydra_msgs::RaycastTsdf::Response& res);
+
+  const TsdfRaycaster raycaster_;
+  ros::NodeHandle nh_;
+  ros::ServiceServer service_;
+
+  mutable std::mutex snapshot_mutex_;
+  mutable TsdfSnapshot::Ptr snapshot_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<ReconstructionModule::Sink,
+                                     TsdfRaycastServer,
+                                     Config>("TsdfRaycastServer");
+};
+
+void declare_config(TsdfRaycaster::Config& config);
+void declare_config(TsdfRaycastServer::Config& config);
+
+}  // namespace hydra
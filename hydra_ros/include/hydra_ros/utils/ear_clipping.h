@@ -73,7 +73,7 @@ class TriangleIter {
   using reference = const TriangleView&;
 
  public:
-  TriangleIter(const Polygon* polygon, std::list<size_t>::const_iterator iter);
+  TriangleIter(const Polygon* polygon, size_t index);
 
   reference operator*() const;
   pointer operator->() const;
@@ -94,7 +94,7 @@ class TriangleIter {
  private:
   TriangleView view_;
   const Polygon* polygon_;
-  std::list<size_t>::const_iterator iter_;
+  size_t index_;
 };
 
 class Polygon {
@@ -110,7 +110,8 @@ class Polygon {
 
   TriangleIter end() const;
 
-  const std::list<size_t>& active() const;
+  //! Indices of the remaining vertices in polygon order
+  std::vector<size_t> active() const;
 
   const Vertex* vertex(size_t idx) const;
 
@@ -121,18 +122,39 @@ class Polygon {
   std::vector<std::array<size_t, 3>> triangulate(bool use_first_ear = false);
 
  private:
+  friend TriangleIter;
+
   void filter();
 
   TriangleIter erase(TriangleIter iter);
 
-  TriangleIter minAngleEar(const std::vector<bool>& ears) const;
+  void updateReflex(size_t idx);
+
+  void makeGrid();
 
-  TriangleIter getFirstEar(const std::vector<bool>& ears) const;
+  Eigen::Array2i getCell(const Eigen::Vector2d& pos) const;
 
  private:
   bool is_ccw_;
-  std::list<size_t> active_;
   std::vector<Vertex> vertices_;
+
+  // remaining vertices as a circular doubly linked list over vertices_
+  size_t head_;
+  size_t num_active_;
+  std::vector<size_t> prev_;
+  std::vector<size_t> next_;
+  std::vector<bool> is_active_;
+  //! Whether each remaining vertex is not strictly convex (only these can lie inside
+  //! an ear)
+  std::vector<bool> is_reflex_;
+
+  // uniform grid over the vertices so ear tests only look at nearby vertices
+  Eigen::Vector2d grid_origin_;
+  double cell_size_;
+  Eigen::Array2i grid_dims_;
+  //! Start of each cell in cell_vertices_ (plus one past the end)
+  std::vector<size_t> cell_offsets_;
+  std::vector<size_t> cell_vertices_;
 };
 
 }  // namespace hydra
@@ -0,0 +1,226 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spatial_hash/hash.h>
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+//! Integer division that rounds towards negative infinity
+inline int64_t floorDiv(int64_t value, int64_t divisor) {
+  const auto result = value / divisor;
+  return (value % divisor != 0 && value < 0) ? result - 1 : result;
+}
+
+//! Rectangle of cells [min, max) in the frame of a grid
+struct GridRegion {
+  Eigen::Vector2i min = Eigen::Vector2i::Zero();
+  Eigen::Vector2i max = Eigen::Vector2i::Zero();
+
+  bool empty() const { return (max.array() <= min.array()).any(); }
+};
+
+/**
+ * @brief Tracks the block columns (with z = 0) of a layer that have blocks in a band of
+ * block z-indices, so that grids built from the layer only need to recompute columns
+ * with new or updated blocks and clear columns that lost all of their blocks
+ */
+class BlockColumnTracker {
+ public:
+  struct Changes {
+    //! Columns with blocks that are new or were updated since the last call
+    std::vector<spatial_hash::BlockIndex> updated;
+    //! Columns that no longer have any blocks in the band
+    std::vector<spatial_hash::BlockIndex> removed;
+  };
+
+  template <typename LayerT>
+  Changes update(const LayerT& layer, int64_t min_block_z, int64_t max_block_z) {
+    spatial_hash::BlockIndexSet columns;
+    spatial_hash::BlockIndexSet updated;
+    for (const auto& block : layer) {
+      if (block.index.z() < min_block_z || block.index.z() > max_block_z) {
+        continue;
+      }
+
+      const spatial_hash::BlockIndex column(block.index.x(), block.index.y(), 0);
+      columns.insert(column);
+      if (block.updated || !columns_.count(column)) {
+        updated.insert(column);
+      }
+    }
+
+    Changes changes;
+    changes.updated.assign(updated.begin(), updated.end());
+    for (const auto& column : columns_) {
+      if (!columns.count(column)) {
+        changes.removed.push_back(column);
+      }
+    }
+
+    columns_ = std::move(columns);
+    return changes;
+  }
+
+  //! Whether the column had blocks in the band during the last update
+  bool contains(const spatial_hash::BlockIndex& column) const {
+    return columns_.count(column) > 0;
+  }
+
+  //! Forget all columns so that every column counts as new during the next update
+  void clear() { columns_.clear(); }
+
+ private:
+  spatial_hash::BlockIndexSet columns_;
+};
+
+//! Cells [min, max) in global voxel indices covered by the block columns
+inline GridRegion getColumnBounds(
+    const std::vector<spatial_hash::BlockIndex>& columns, int voxels_per_side) {
+  GridRegion bounds{Eigen::Vector2i::Constant(std::numeric_limits<int>::max()),
+                    Eigen::Vector2i::Constant(std::numeric_limits<int>::lowest())};
+  for (const auto& column : columns) {
+    const Eigen::Vector2i lower = column.head<2>() * voxels_per_side;
+    bounds.min = bounds.min.cwiseMin(lower);
+    bounds.max =
+        bounds.max.cwiseMax(lower + Eigen::Vector2i::Constant(voxels_per_side));
+  }
+
+  return bounds;
+}
+
+/**
+ * @brief Collate block columns into regions of cells relative to the grid origin,
+ * merging horizontal runs of neighboring columns within each row of blocks. Distant
+ * changes stay in separate regions instead of one bounding box covering both.
+ */
+inline std::vector<GridRegion> getColumnRegions(
+    const std::vector<spatial_hash::BlockIndex>& columns,
+    int voxels_per_side,
+    const Eigen::Vector2i& grid_origin) {
+  std::map<int, std::vector<int>> rows;
+  for (const auto& column : columns) {
+    rows[column.y()].push_back(column.x());
+  }
+
+  std::vector<GridRegion> regions;
+  for (auto& [y, xs] : rows) {
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    size_t start = 0;
+    for (size_t i = 1; i <= xs.size(); ++i) {
+      if (i < xs.size() && xs[i] == xs[i - 1] + 1) {
+        continue;
+      }
+
+      GridRegion region;
+      region.min = Eigen::Vector2i(xs[start], y) * voxels_per_side - grid_origin;
+      region.max =
+          Eigen::Vector2i(xs[i - 1] + 1, y + 1) * voxels_per_side - grid_origin;
+      regions.push_back(region);
+      start = i;
+    }
+  }
+
+  return regions;
+}
+
+//! Row-major cells [min, min + dims) of a 2D grid in global voxel indices
+struct GridExtent {
+  Eigen::Vector2i min = Eigen::Vector2i::Zero();
+  Eigen::Vector2i dims = Eigen::Vector2i::Zero();
+
+  bool empty() const { return dims.x() <= 0 || dims.y() <= 0; }
+
+  bool contains(const Eigen::Vector2i& min_cell, const Eigen::Vector2i& max_cell) const {
+    return !empty() && (min_cell.array() >= min.array()).all() &&
+           (max_cell.array() <= (min + dims).array()).all();
+  }
+};
+
+/**
+ * @brief Get an extent that covers the current extent and the cells [min_cell,
+ * max_cell), growing by at least half the current size in any direction that needs to
+ * grow so that the cost of copying is amortized over many updates
+ */
+inline GridExtent growExtent(const GridExtent& extent,
+                             const Eigen::Vector2i& min_cell,
+                             const Eigen::Vector2i& max_cell,
+                             int min_padding) {
+  if (extent.empty()) {
+    return {min_cell, max_cell - min_cell};
+  }
+
+  const Eigen::Vector2i curr_max = extent.min + extent.dims;
+  Eigen::Vector2i new_min = extent.min;
+  Eigen::Vector2i new_max = curr_max;
+  for (int i = 0; i < 2; ++i) {
+    const int padding = std::max(extent.dims(i) / 2, min_padding);
+    if (min_cell(i) < extent.min(i)) {
+      new_min(i) = min_cell(i) - padding;
+    }
+
+    if (max_cell(i) > curr_max(i)) {
+      new_max(i) = max_cell(i) + padding;
+    }
+  }
+
+  return {new_min, new_max - new_min};
+}
+
+//! Move row-major values stored for one extent into a (larger) extent
+template <typename T>
+void resizeGrid(const GridExtent& from,
+                const GridExtent& to,
+                T fill,
+                std::vector<T>& values) {
+  std::vector<T> new_values(to.dims.x() * to.dims.y(), fill);
+  const Eigen::Vector2i offset = from.min - to.min;
+  for (int r = 0; r < from.dims.y(); ++r) {
+    const auto old_row = values.begin() + r * from.dims.x();
+    std::copy(old_row,
+              old_row + from.dims.x(),
+              new_values.begin() + (r + offset.y()) * to.dims.x() + offset.x());
+  }
+
+  values = std::move(new_values);
+}
+
+}  // namespace hydra
@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra_msgs/OccupancyBlocks.h>
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+enum class VoxelOccupancy : uint8_t { UNKNOWN = 0, FREE = 1, OCCUPIED = 2 };
+
+//! Number of bytes needed to store a block at 2 bits per voxel
+inline size_t packedBlockSize(size_t voxels_per_side) {
+  return (voxels_per_side * voxels_per_side * voxels_per_side + 3) / 4;
+}
+
+//! Linear index of a voxel in a packed block (x varies fastest, then y, then z)
+inline size_t packedVoxelIndex(size_t voxels_per_side, size_t x, size_t y, size_t z) {
+  return x + voxels_per_side * (y + voxels_per_side * z);
+}
+
+inline void packOccupancy(size_t index,
+                          VoxelOccupancy value,
+                          std::vector<uint8_t>& states) {
+  const auto shift = 2 * (index % 4);
+  auto& byte = states[index / 4];
+  byte = (byte & ~(0x3 << shift)) | (static_cast<uint8_t>(value) << shift);
+}
+
+inline VoxelOccupancy unpackOccupancy(const std::vector<uint8_t>& states, size_t index) {
+  return static_cast<VoxelOccupancy>((states[index / 4] >> (2 * (index % 4))) & 0x3);
+}
+
+/**
+ * @brief Queryable local 3D occupancy map reconstructed from the delta-only stream of
+ * hydra_msgs/OccupancyBlocks messages
+ */
+class OccupancyBlockMap {
+ public:
+  /**
+   * @brief Apply changed and removed blocks (or replace the map for full updates)
+   *
+   * Deltas only apply on top of every previous message, so a gap in the sequence
+   * clears the map and further deltas are ignored until the next full update (which
+   * can be requested through the request_full_update service of the publisher).
+   *
+   * @returns false if the message was not applied because messages were missed
+   */
+  bool update(const hydra_msgs::OccupancyBlocks& msg);
+
+  //! Whether every message since the last full update has been applied
+  bool synchronized() const { return synchronized_; }
+
+  //! Get the occupancy of the voxel containing the point (unknown if not in the map)
+  VoxelOccupancy getOccupancy(const Eigen::Vector3f& point) const;
+
+  //! Drop all blocks with origins further than the radius from the center
+  void prune(const Eigen::Vector3f& center, float radius);
+
+  void clear();
+
+  size_t numBlocks() const { return blocks_.size(); }
+
+  float voxelSize() const { return voxel_size_; }
+
+ private:
+  struct IndexHash {
+    size_t operator()(const Eigen::Vector3i& index) const {
+      // multiply as unsigned values so that overflow wraps instead of being undefined
+      return static_cast<size_t>(index.x()) * 73856093 ^
+             static_cast<size_t>(index.y()) * 19349669 ^
+             static_cast<size_t>(index.z()) * 83492791;
+    }
+  };
+
+  float voxel_size_ = 0.0f;
+  size_t voxels_per_side_ = 0;
+  bool synchronized_ = false;
+  uint64_t sequence_ = 0;
+  std::unordered_map<Eigen::Vector3i, std::vector<uint8_t>, IndexHash> blocks_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/frontend/gvd_place_extractor.h>
+#include <hydra/places/gvd_voxel.h>
+#include <hydra/reconstruction/reconstruction_module.h>
+#include <ros/ros.h>
+#include <std_srvs/Empty.h>
+
+#include <atomic>
+
+namespace hydra {
+
+/**
+ * @brief Publishes blocks of a TSDF or GVD layer as bit-packed voxel occupancy (see
+ * occupancy_blocks.h), only sending blocks whose occupancy changed since the last call
+ *
+ * Every message carries a sequence number. Subscribers that detect a gap can call the
+ * request_full_update service to get every block again.
+ */
+class OccupancyBlocksPublisher {
+ public:
+  struct Config {
+    double min_observation_weight = 1.0e-6;
+    double min_distance = 0.3;
+    //! Minimum time between full updates (0 only sends them on subscribe or request)
+    double full_update_period_s = 0.0;
+  } const config;
+
+  OccupancyBlocksPublisher(const Config& config, const ros::NodeHandle& nh);
+
+  virtual ~OccupancyBlocksPublisher() = default;
+
+  void publishTsdf(uint64_t timestamp_ns, const TsdfLayer& tsdf) const;
+
+  void publishGvd(uint64_t timestamp_ns, const places::GvdLayer& gvd) const;
+
+ private:
+  template <typename BlockT>
+  void publishImpl(uint64_t timestamp_ns,
+                   const spatial_hash::VoxelLayer<BlockT>& layer) const;
+
+  bool handleFullUpdate(std_srvs::Empty::Request& req, std_srvs::Empty::Response& res);
+
+  ros::NodeHandle nh_;
+  ros::Publisher pub_;
+  ros::ServiceServer full_update_service_;
+  mutable std::atomic<bool> send_full_;
+  mutable uint64_t last_full_ns_;
+  mutable uint64_t sequence_;
+  //! last packed states sent for each block
+  mutable spatial_hash::BlockIndexMap<std::vector<uint8_t>> sent_;
+};
+
+class TsdfOccupancyBlocksPublisher : public ReconstructionModule::Sink {
+ public:
+  struct Config {
+    std::string ns = "~tsdf";
+    OccupancyBlocksPublisher::Config extraction;
+  } const config;
+
+  explicit TsdfOccupancyBlocksPublisher(const Config& config);
+
+  virtual ~TsdfOccupancyBlocksPublisher() = default;
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3d& world_T_sensor,
+            const TsdfLayer& tsdf,
+            const ReconstructionOutput& msg) const override;
+
+ private:
+  OccupancyBlocksPublisher pub_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<ReconstructionModule::Sink,
+                                     TsdfOccupancyBlocksPublisher,
+                                     Config>("TsdfOccupancyBlocksPublisher");
+};
+
+class GvdOccupancyBlocksPublisher : public GvdPlaceExtractor::Sink {
+ public:
+  struct Config {
+    std::string ns = "~gvd";
+    OccupancyBlocksPublisher::Config extraction;
+  } const config;
+
+  explicit GvdOccupancyBlocksPublisher(const Config& config);
+
+  virtual ~GvdOccupancyBlocksPublisher() = default;
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3f& world_T_sensor,
+            const places::GvdLayer& gvd,
+            const places::GraphExtractorInterface* extractor) const override;
+
+ private:
+  OccupancyBlocksPublisher pub_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<GvdPlaceExtractor::Sink,
+                                     GvdOccupancyBlocksPublisher,
+                                     Config>("GvdOccupancyBlocksPublisher");
+};
+
+void declare_config(OccupancyBlocksPublisher::Config& config);
+void declare_config(TsdfOccupancyBlocksPublisher::Config& config);
+void declare_config(GvdOccupancyBlocksPublisher::Config& config);
+
+}  // namespace hydra
@@ -37,10 +37,33 @@
 #include <hydra/frontend/gvd_place_extractor.h>
 #include <hydra/places/gvd_voxel.h>
 #include <hydra/reconstruction/reconstruction_module.h>
+#include <nav_msgs/OccupancyGrid.h>
 #include <ros/ros.h>
 
+#include <atomic>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
 namespace hydra {
 
+//! Compact voxel that only stores what is needed to rasterize occupancy
+struct OccupancyVoxel {
+  bool observed = false;
+  bool occupied = false;
+};
+
+struct OccupancyBlock : public spatial_hash::VoxelBlock<OccupancyVoxel> {
+  using Ptr = std::shared_ptr<OccupancyBlock>;
+  using ConstPtr = std::shared_ptr<const OccupancyBlock>;
+  using spatial_hash::VoxelBlock<OccupancyVoxel>::VoxelBlock;
+
+  bool updated = false;
+};
+
+using OccupancyLayer = spatial_hash::VoxelLayer<OccupancyBlock>;
+
+class IncrementalOccupancyGrid;
+
 class OccupancyPublisher {
  public:
   struct Config {
@@ -52,6 +75,17 @@ class OccupancyPublisher {
     bool add_robot_footprint = false;
     Eigen::Vector3f footprint_min;
     Eigen::Vector3f footprint_max;
+    //! Minimum time between full grids, with only changed regions published as
+    //! updates in between (0 only sends full grids on start, resize or subscribe)
+    double full_grid_period_s = 0.0;
+    //! Number of threads used to rasterize changed block columns
+    size_t num_threads = 4;
+    //! Cells per side of tiles published for each level (0 disables tiles)
+    size_t tile_size = 0;
+    //! Number of tile levels, where each level halves the resolution
+    size_t num_tile_levels = 3;
+    //! Side length of the robot-centered grid (0 disables the local grid)
+    double local_window_m = 0.0;
   } const config;
 
   OccupancyPublisher(const Config& config, const ros::NodeHandle& nh);
@@ -66,9 +100,128 @@ class OccupancyPublisher {
                   const Eigen::Isometry3d& world_T_sensor,
                   const places::GvdLayer& gvd) const;
 
+  void publishOccupancy(uint64_t timestamp_ns,
+                        const Eigen::Isometry3d& world_T_sensor,
+                        const OccupancyLayer& layer) const;
+
  private:
+  bool hasSubscribers() const;
+
+  void publish(uint64_t timestamp_ns, const Eigen::Isometry3d& world_T_sensor) const;
+
+  void publishUpdates() const;
+
+  void publishTiles() const;
+
   ros::NodeHandle nh_;
   ros::Publisher pub_;
+  ros::Publisher update_pub_;
+  ros::Publisher local_pub_;
+  std::vector<ros::Publisher> tile_pubs_;
+  std::unique_ptr<IncrementalOccupancyGrid> grid_;
+  mutable std::atomic<bool> send_full_grid_;
+  mutable uint64_t last_full_grid_ns_;
+  mutable std::atomic<bool> send_all_tiles_;
+};
+
+/**
+ * @brief Rasterize every cell of a single block column into the grid
+ * @param column Block column index (with z = 0)
+ * @param slice_index Global voxel z-index of the lowest slice
+ * @param check_footprint Mark cells inside the robot footprint as free
+ * @param grid_origin Global voxel index of the lower left cell of the grid
+ */
+template <typename BlockT>
+void fillOccupancyColumn(const OccupancyPublisher::Config& config,
+                         const spatial_hash::VoxelLayer<BlockT>& layer,
+                         const Eigen::Isometry3f& sensor_T_world,
+                         const BlockIndex& column,
+                         int64_t slice_index,
+                         bool check_footprint,
+                         const Eigen::Vector2i& grid_origin,
+                         nav_msgs::OccupancyGrid& msg);
+
+/**
+ * @brief Copy observed voxels of blocks that are new or updated into the compact layer
+ *
+ * Blocks copied by the previous call (stored in collated) have their updated flags
+ * reset first, so afterwards only the blocks copied by this call are marked updated.
+ */
+void collate(const OccupancyPublisher::Config& config,
+             const TsdfLayer& layer_in,
+             OccupancyLayer& layer_out,
+             std::vector<BlockIndex>& collated);
+
+void collate(const OccupancyPublisher::Config& config,
+             const places::GvdLayer& layer_in,
+             OccupancyLayer& layer_out,
+             std::vector<BlockIndex>& collated);
+
+/**
+ * @brief Occupancy grid that persists between calls and only re-rasterizes the block
+ * columns that changed (or were added or removed) since the last update
+ */
+class IncrementalOccupancyGrid {
+ public:
+  using Config = OccupancyPublisher::Config;
+
+  explicit IncrementalOccupancyGrid(const Config& config);
+
+  /**
+   * @brief Update the grid from any changed blocks in the layer
+   * @returns number of block columns that were re-rasterized
+   */
+  size_t update(const Eigen::Isometry3d& world_T_sensor, const TsdfLayer& layer);
+
+  size_t update(const Eigen::Isometry3d& world_T_sensor,
+                const places::GvdLayer& layer);
+
+  size_t update(const Eigen::Isometry3d& world_T_sensor, const OccupancyLayer& layer);
+
+  //! Drop all grid state so that the next update rebuilds everything
+  void reset();
+
+  const nav_msgs::OccupancyGrid& grid() const { return msg_; }
+
+  nav_msgs::OccupancyGrid& grid() { return msg_; }
+
+  //! Global voxel index of the lower left cell of the grid
+  const Eigen::Vector2i& origin() const { return origin_; }
+
+  //! Global voxel z-index of the lowest slice used for the last update
+  int64_t sliceIndex() const { return slice_index_; }
+
+  //! Regions of the grid that changed during the last update
+  const std::vector<GridRegion>& changedRegions() const { return regions_; }
+
+  //! Whether the grid was reallocated or cleared since the last full grid was taken
+  bool requiresFullGrid() const { return requires_full_; }
+
+  //! Mark that consumers have received the full grid
+  void clearRequiresFullGrid() { requires_full_ = false; }
+
+ private:
+  template <typename BlockT>
+  size_t updateImpl(const Eigen::Isometry3d& world_T_sensor,
+                    const spatial_hash::VoxelLayer<BlockT>& layer);
+
+  void reserve(const GridRegion& cells);
+
+  void clearColumn(const BlockIndex& column);
+
+  const Config config_;
+  nav_msgs::OccupancyGrid msg_;
+  //! global voxel index of the lower left cell of the grid
+  Eigen::Vector2i origin_;
+  float voxel_size_;
+  int voxels_per_side_;
+  //! global voxel z-index of the lowest slice
+  int64_t slice_index_;
+  BlockColumnTracker columns_;
+  //! block columns covered by the robot footprint last update
+  std::vector<BlockIndex> footprint_columns_;
+  std::vector<GridRegion> regions_;
+  bool requires_full_;
 };
 
 class TsdfOccupancyPublisher : public ReconstructionModule::Sink {
@@ -90,7 +243,8 @@ class TsdfOccupancyPublisher : public ReconstructionModule::Sink {
 
  private:
   OccupancyPublisher pub_;
-  mutable TsdfLayer::Ptr tsdf_;
+  mutable OccupancyLayer::Ptr tsdf_;
+  mutable std::vector<BlockIndex> collated_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<ReconstructionModule::Sink,
@@ -117,7 +271,8 @@ class GvdOccupancyPublisher : public GvdPlaceExtractor::Sink {
 
  private:
   OccupancyPublisher pub_;
-  mutable places::GvdLayer::Ptr gvd_;
+  mutable OccupancyLayer::Ptr gvd_;
+  mutable std::vector<BlockIndex> collated_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<GvdPlaceExtractor::Sink,
@@ -0,0 +1,73 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <nav_msgs/OccupancyGrid.h>
+
+#include <Eigen/Geometry>
+
+namespace hydra {
+
+class IncrementalOccupancyGrid;
+
+/**
+ * @brief Get the tiles that overlap regions that changed during the last grid update
+ * @param grid Grid to get changes from
+ * @param tile_size Number of cells per tile side
+ * @param level Downsampling level (each level halves the resolution)
+ * @param all Return every tile that overlaps the grid instead of only changed tiles
+ * @returns Sorted tile indices
+ */
+std::vector<Eigen::Vector2i> getChangedTiles(const IncrementalOccupancyGrid& grid,
+                                             size_t tile_size,
+                                             size_t level,
+                                             bool all = false);
+
+/**
+ * @brief Extract a tile from the grid, downsampling by keeping the highest value
+ * (occupied over free over unknown) of the cells that fall in each tile cell
+ */
+void extractTile(const IncrementalOccupancyGrid& grid,
+                 const Eigen::Vector2i& tile,
+                 size_t tile_size,
+                 size_t level,
+                 nav_msgs::OccupancyGrid& msg);
+
+//! Extract a square window of the grid centered on a position
+void extractWindow(const IncrementalOccupancyGrid& grid,
+                   const Eigen::Vector2d& center,
+                   double window_size,
+                   nav_msgs::OccupancyGrid& msg);
+
+}  // namespace hydra
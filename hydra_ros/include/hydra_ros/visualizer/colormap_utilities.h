@@ -35,6 +35,10 @@
 #pragma once
 #include <std_msgs/ColorRGBA.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra::dsg_utils {
@@ -53,4 +57,58 @@ std_msgs::ColorRGBA makeColorMsg(const Color& color, double alpha = -1.0);
 
 Color interpolateColorMap(const ColormapConfig& config, double ratio);
 
+/**
+ * @brief Colormap sampled at evenly spaced ratios so that coloring is a table lookup
+ *
+ * Ratios are rounded to the nearest entry, which is finer than the 8-bit colors the
+ * colormap produces for the default size.
+ */
+class ColormapLut {
+ public:
+  explicit ColormapLut(const ColormapConfig& config, size_t num_entries = 1024);
+
+  const Color& operator()(double ratio) const { return colors_[getIndex(ratio)]; }
+
+  std_msgs::ColorRGBA getColorMsg(double ratio, double alpha) const {
+    auto msg = msgs_[getIndex(ratio)];
+    msg.a = alpha;
+    return msg;
+  }
+
+  //! Append the color of every ratio to colors
+  void colorAll(const std::vector<double>& ratios,
+                double alpha,
+                std::vector<std_msgs::ColorRGBA>& colors) const;
+
+  //! Whether the table was built from a colormap with the same values
+  bool matches(const ColormapConfig& config) const;
+
+  size_t size() const { return colors_.size(); }
+
+ private:
+  size_t getIndex(double ratio) const {
+    // NaN would pass through the clamp and cast to an arbitrary index
+    if (!std::isfinite(ratio)) {
+      return 0;
+    }
+
+    ratio = std::clamp(ratio, 0.0, 1.0);
+    return static_cast<size_t>(ratio * max_index_ + 0.5);
+  }
+
+  ColormapConfig config_;
+  double max_index_;
+  std::vector<Color> colors_;
+  std::vector<std_msgs::ColorRGBA> msgs_;
+};
+
+/**
+ * @brief Get a lookup table for the colormap
+ *
+ * Tables are cached per thread and only rebuilt when the colormap values change (e.g.
+ * through dynamic reconfigure), so this is cheap enough to call once per marker. The
+ * reference stays valid until the thread requests several other colormaps.
+ */
+const ColormapLut& getColormapLut(const ColormapConfig& config);
+
 }  // namespace hydra::dsg_utils
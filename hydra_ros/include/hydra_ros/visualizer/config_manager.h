@@ -36,6 +36,9 @@
 #include <dynamic_reconfigure/server.h>
 #include <ros/ros.h>
 
+#include <atomic>
+#include <mutex>
+
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra {
@@ -48,15 +51,12 @@ class ConfigWrapper {
   using UpdateCallback = std::function<void()>;
 
   ConfigWrapper(const ros::NodeHandle& nh, const std::string& ns)
-      : nh_(nh, ns), changed_(true), on_update_callback_([]() {}) {
+      : nh_(nh, ns), on_update_callback_([]() {}) {
     server_ = std::make_unique<Server>(nh_);
     server_->setCallback(boost::bind(&ConfigWrapper<Config>::update, this, _1, _2));
   }
 
-  bool hasChange() { return changed_; }
-
-  void clearChangeFlag() { changed_ = false; }
-
+  //! Only stable while the reconfigure callbacks are serviced on the drawing thread
   const Config& get() const { return config_; };
 
   void setUpdateCallback(UpdateCallback callback) {
@@ -66,14 +66,12 @@ class ConfigWrapper {
  private:
   void update(Config& config, uint32_t) {
     config_ = config;
-    changed_ = true;
     on_update_callback_();
   }
 
  private:
   ros::NodeHandle nh_;
 
-  bool changed_;
   Config config_;
 
   std::unique_ptr<Server> server_;
@@ -93,10 +91,23 @@ class ConfigManager {
 
   virtual void reset(const DynamicSceneGraph& graph);
 
+  //! Constant time check for any config update since the flags were last cleared
   virtual bool hasChange() const;
 
   virtual void clearChangeFlags();
 
+  //! Counter that every config update increments
+  uint64_t generation() const { return generation_; }
+
+  //! Generation of the last update to the visualizer config or a colormap
+  uint64_t getGlobalGeneration() const;
+
+  //! Generation of the last update to a layer config (0 if never updated)
+  uint64_t getLayerGeneration(LayerId layer) const;
+
+  //! Generation of the last update to a dynamic layer config (0 if never updated)
+  uint64_t getDynamicLayerGeneration(LayerId layer) const;
+
   const VisualizerConfig& getVisualizerConfig() const;
 
   const LayerConfig* getLayerConfig(LayerId layer) const;
@@ -106,8 +117,29 @@ class ConfigManager {
   const ColormapConfig& getColormapConfig(const std::string& name) const;
 
  private:
+  template <typename Config>
+  typename ConfigWrapper<Config>::Ptr makeConfig(
+      const std::string& ns, const std::function<void()>& on_update) const {
+    auto config = std::make_shared<ConfigWrapper<Config>>(nh_, ns);
+    config->setUpdateCallback(on_update);
+    return config;
+  }
+
+  //! Bump the generation and stamp it on a layer (or on everything if no layers)
+  void recordChange(std::map<LayerId, uint64_t>* generations, LayerId layer) const;
+
   ros::NodeHandle nh_;
 
+  //! Written from the dynamic_reconfigure callbacks, read by the redraw loop
+  mutable std::atomic<uint64_t> generation_;
+  uint64_t cleared_generation_;
+  mutable std::mutex generation_mutex_;
+  mutable uint64_t global_generation_;
+  mutable std::map<LayerId, uint64_t> layer_generations_;
+  mutable std::map<LayerId, uint64_t> dynamic_layer_generations_;
+
+  //! Guards lazily creating configs when markers are drawn from several threads
+  mutable std::mutex mutex_;
   mutable ConfigWrapper<VisualizerConfig>::Ptr visualizer_config_;
   mutable std::map<LayerId, ConfigWrapper<LayerConfig>::Ptr> layer_configs_;
   mutable std::map<LayerId, ConfigWrapper<DynamicLayerConfig>::Ptr>
@@ -36,6 +36,9 @@
 #include <hydra/common/dsg_types.h>
 #include <ros/ros.h>
 
+#include <atomic>
+#include <vector>
+
 #include "hydra_ros/visualizer/config_manager.h"
 
 namespace hydra {
@@ -61,8 +64,70 @@ class DsgVisualizerPlugin {
 
   virtual void clearChangeFlag() {}
 
+  /**
+   * @brief Check whether drawing would reach anyone
+   *
+   * Defaults to checking the subscriber count of every publisher created through
+   * advertise(). Plugins without any such publisher always draw.
+   */
+  virtual bool needsDraw() const {
+    if (pubs_.empty()) {
+      return true;
+    }
+
+    for (const auto& pub : pubs_) {
+      if (pub.getNumSubscribers() > 0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  //! Whether a draw was skipped and someone has subscribed since
+  bool hasPendingDraw() const { return pending_draw_; }
+
+  //! Draw if anyone is subscribed, otherwise defer the draw until someone connects
+  void drawIfNeeded(const ConfigManager& configs,
+                    const std_msgs::Header& header,
+                    const DynamicSceneGraph& graph) {
+    // marked before checking so that a subscriber connecting in between still
+    // requests the deferred draw
+    skipped_draw_ = true;
+    if (!needsDraw()) {
+      return;
+    }
+
+    skipped_draw_ = false;
+    pending_draw_ = false;
+    draw(configs, header, graph);
+  }
+
  protected:
+  //! Advertise a latched topic whose subscribers gate drawing
+  template <typename M>
+  ros::Publisher advertise(const std::string& topic, uint32_t queue_size) {
+    auto pub = nh_.advertise<M>(
+        topic,
+        queue_size,
+        [this](const ros::SingleSubscriberPublisher&) {
+          if (skipped_draw_) {
+            pending_draw_ = true;
+          }
+        },
+        ros::SubscriberStatusCallback(),
+        ros::VoidConstPtr(),
+        true);
+    pubs_.push_back(pub);
+    return pub;
+  }
+
   ros::NodeHandle nh_;
+
+ private:
+  std::vector<ros::Publisher> pubs_;
+  std::atomic<bool> skipped_draw_{false};
+  std::atomic<bool> pending_draw_{false};
 };
 
 }  // namespace hydra
@@ -34,9 +34,14 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <ros/ros.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -82,6 +87,9 @@ class DynamicSceneGraphVisualizer {
 
   void setNeedRedraw() { need_redraw_ = true; }
 
+  //! Resend the last drawn markers on the next redraw without regenerating them
+  void republishCached() { republish_cached_ = true; }
+
   DynamicSceneGraph::Ptr getGraph() const { return scene_graph_; }
 
   void setLayerColorFunction(LayerId layer, const ColorFunction& func);
@@ -111,7 +119,22 @@ class DynamicSceneGraphVisualizer {
                          const std::string& ns,
                          MarkerArray& msg);
 
-  void addMultiMarkerIfValid(const Marker& marker, MarkerArray& msg);
+  void addMultiMarkerIfValid(Marker marker, MarkerArray& msg);
+
+  //! Move markers into the message, keeping the non-delete markers for republishing
+  void addCachedMarkers(const std::string& key,
+                        size_t fingerprint,
+                        MarkerArray& markers,
+                        MarkerArray& msg);
+
+  //! Check whether a cached marker group exists and was drawn from the same state
+  bool isCached(const std::string& key, size_t fingerprint) const;
+
+  //! Send every cached marker so that new subscribers see the full graph
+  void publishCached();
+
+  //! Copy every non-delete marker into the cache, reusing the cached allocations
+  void updateCache(const MarkerArray& markers, MarkerArray& cache) const;
 
   void displayLoop(const ros::WallTimerEvent&);
 
@@ -119,6 +142,9 @@ class DynamicSceneGraphVisualizer {
                    const SceneGraphLayer& layer,
                    MarkerArray& msg);
 
+  //! Publish an empty cloud for a layer if a non-empty one was published before
+  void clearLayerCloud(const std_msgs::Header& header, LayerId layer);
+
   inline std::string getDynamicNodeNamespace(char layer_prefix) const {
     return dynamic_node_ns_prefix_ + layer_prefix;
   }
@@ -177,14 +203,35 @@ class DynamicSceneGraphVisualizer {
 
   void drawDynamicLayers(const std_msgs::Header& header, MarkerArray& msg);
 
+  void drawInterlayerEdges(const std_msgs::Header& header,
+                           const std::map<LayerId, LayerConfig>& all_configs,
+                           MarkerArray& msg);
+
+  void drawDynamicEdges(const std_msgs::Header& header,
+                        const std::map<LayerId, LayerConfig>& all_configs,
+                        const std::string& dynamic_interlayer_edge_prefix,
+                        MarkerArray& msg);
+
   Color getParentColor(const SceneGraphNode& node) const;
 
+  //! Look up the view frame and flag a redraw if it moved far enough
+  void updateLodView();
+
+  //! Horizontal distance between a node and the current view (0 if LOD is off)
+  double getLodDistance(const SceneGraphNode& node) const;
+
+  //! Filter for the nodes to draw given the distance to the view (empty if LOD is off)
+  FilterFunction getLodNodeFilter(const VisualizerConfig& config) const;
+
+  //! Filter for the endpoints of edges to draw (empty if LOD is off)
+  FilterFunction getLodEdgeFilter(const VisualizerConfig& config) const;
+
  protected:
   ros::NodeHandle nh_;
   ros::WallTimer visualizer_loop_timer_;
   ConfigManager::Ptr config_manager_;
 
-  bool need_redraw_;
+  std::atomic<bool> need_redraw_;
   bool periodic_redraw_;
   std::string visualizer_frame_;
   DynamicSceneGraph::Ptr scene_graph_;
@@ -209,6 +256,45 @@ class DynamicSceneGraphVisualizer {
   std::map<LayerId, std::set<NodeId>> curr_labels_;
   std::set<std::string> published_dynamic_labels_;
 
+  //! Markers (and the fingerprint of the graph state they were drawn from) per group
+  struct MarkerCache {
+    size_t fingerprint = 0;
+    MarkerArray markers;
+  };
+
+  //! Group of markers that can be drawn independently of every other group
+  struct DrawTask {
+    std::string key;
+    size_t fingerprint;
+    std::function<void(MarkerArray&)> draw;
+    MarkerArray markers = {};
+  };
+
+  size_t num_draw_threads_;
+  //! Guards published_multimarkers_ while groups are drawn concurrently
+  std::mutex published_mutex_;
+
+  //! Whether the next redraw has to rebuild every layer (e.g. after config changes)
+  bool redraw_all_;
+  //! Config generation that the current markers were drawn with
+  uint64_t last_config_generation_ = 0;
+  std::atomic<bool> republish_cached_;
+  std::map<std::string, MarkerCache> marker_caches_;
+  MarkerCache dynamic_marker_cache_;
+  //! Point/color storage recycled from previously published markers
+  MarkerBuffers marker_buffers_;
+
+  //! Latched node clouds for layers drawn with use_point_cloud
+  std::map<LayerId, ros::Publisher> cloud_pubs_;
+  std::set<LayerId> published_clouds_;
+
+  //! Frame that level of detail is computed relative to (e.g. a camera frame)
+  std::string lod_view_frame_;
+  std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
+  //! View position the current markers were drawn for
+  std::optional<Eigen::Vector2d> lod_view_;
+
   ros::Publisher dsg_pub_;
   ros::Publisher dynamic_layers_viz_pub_;
   std::list<std::shared_ptr<DsgVisualizerPlugin>> plugins_;
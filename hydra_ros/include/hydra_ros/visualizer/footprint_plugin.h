@@ -37,6 +37,7 @@
 #include <std_srvs/SetBool.h>
 
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/polygon_utilities.h"
 
 namespace hydra {
 
@@ -71,6 +72,8 @@ class FootprintPlugin : public DsgVisualizerPlugin {
  protected:
   ros::Publisher pub_;
   std::set<std::string> namespaces_;
+  //! Footprints drawn last, rebuilt only when the node moves or changes radius
+  PolygonCache polygons_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
@@ -35,11 +35,14 @@
 #pragma once
 
 #include <config_utilities/virtual_config.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <spark_dsg/zmq_interface.h>
 #include <std_srvs/Empty.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 
 #include "hydra_ros/utils/dsg_streaming_interface.h"
 #include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
@@ -59,6 +62,8 @@ struct HydraVisualizerConfig {
   std::string zmq_url = "tcp://127.0.0.1:8001";
   size_t zmq_num_threads = 2;
   size_t zmq_poll_time_ms = 10;
+  //! Period for resending the cached markers of a loaded graph (disabled if <= 0)
+  double republish_period_s = 5.0;
 
   // Specify additional plugins that should be loaded <name, config>
   std::map<std::string, config::VirtualConfig<DsgVisualizerPlugin>> plugins;
@@ -74,12 +79,15 @@ struct HydraVisualizer {
 
   bool handleReload(std_srvs::Empty::Request&, std_srvs::Empty::Response&);
   bool handleRedraw(std_srvs::Empty::Request&, std_srvs::Empty::Response&);
+  void republishLoop(const ros::WallTimerEvent&);
 
   void addPlugin(DsgVisualizerPlugin::Ptr plugin);
   void clearPlugins();
   inline DynamicSceneGraphVisualizer& getVisualizer() { return *visualizer_; }
 
   void spinRos();
+  void receiveLoop(ros::CallbackQueue* queue);
+  void drawLoop();
   void spinFile();
   void spinZmq();
   void spin();
@@ -92,6 +100,14 @@ struct HydraVisualizer {
   std::unique_ptr<std::ofstream> size_log_file_;
   ros::ServiceServer reload_service_;
   ros::ServiceServer redraw_service_;
+  ros::WallTimer republish_timer_;
+
+  //! Newest received graph that has not been drawn yet (intermediate ones are dropped)
+  DynamicSceneGraph::Ptr latest_graph_;
+  //! Set while the draw loop is ready for a new graph, so graphs are copied lazily
+  bool graph_requested_ = false;
+  std::mutex graph_mutex_;
+  std::condition_variable graph_cv_;
 };
 
 }  // namespace hydra
@@ -37,6 +37,8 @@
 #include <kimera_pgmo/mesh_traits.h>
 #include <spark_dsg/mesh.h>
 
+#include <vector>
+
 namespace hydra {
 
 class SemanticColorMap;
@@ -56,6 +58,14 @@ struct MeshColoring {
    */
   virtual spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh,
                                           size_t i) const = 0;
+
+  /**
+   * @brief Color every vertex of the mesh at once. The default calls getVertexColor
+   * for each vertex; colorings override this with a loop that hoists any per-mesh
+   * work and avoids a virtual call per vertex.
+   */
+  virtual void colorAll(const spark_dsg::Mesh& mesh,
+                        std::vector<spark_dsg::Color>& colors) const;
 };
 
 /**
@@ -69,6 +79,9 @@ struct UniformMeshColoring : public MeshColoring {
     return color_;
   }
 
+  void colorAll(const spark_dsg::Mesh& mesh,
+                std::vector<spark_dsg::Color>& colors) const override;
+
  private:
   const spark_dsg::Color color_;
 };
@@ -82,6 +95,9 @@ struct SemanticMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  void colorAll(const spark_dsg::Mesh& mesh,
+                std::vector<spark_dsg::Color>& colors) const override;
+
  private:
   const SemanticColorMap& colormap_;
 };
@@ -99,6 +115,9 @@ struct FirstSeenMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  void colorAll(const spark_dsg::Mesh& mesh,
+                std::vector<spark_dsg::Color>& colors) const override;
+
  private:
   spark_dsg::Mesh::Timestamp min_;
   spark_dsg::Mesh::Timestamp max_;
@@ -116,6 +135,9 @@ struct LastSeenMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  void colorAll(const spark_dsg::Mesh& mesh,
+                std::vector<spark_dsg::Color>& colors) const override;
+
  private:
   spark_dsg::Mesh::Timestamp min_;
   spark_dsg::Mesh::Timestamp max_;
@@ -133,6 +155,9 @@ struct SeenDurationMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  void colorAll(const spark_dsg::Mesh& mesh,
+                std::vector<spark_dsg::Color>& colors) const override;
+
  private:
   spark_dsg::Mesh::Timestamp max_;
 };
@@ -149,12 +174,16 @@ struct MeshColorAdaptor {
                             MeshColoring::ConstPtr coloring = nullptr);
   virtual ~MeshColorAdaptor() = default;
 
-  std::function<spark_dsg::Color(size_t)> getVertexColor;
+  spark_dsg::Color getVertexColor(size_t i) const {
+    return coloring_ ? colors_[i] : mesh.color(i);
+  }
 
   const spark_dsg::Mesh& mesh;
 
  private:
   const MeshColoring::ConstPtr coloring_;
+  //! Vertex colors from the coloring, computed in one pass on construction
+  std::vector<spark_dsg::Color> colors_;
 };
 
 Eigen::Vector3f pgmoGetVertex(const MeshColorAdaptor& mesh_adaptor,
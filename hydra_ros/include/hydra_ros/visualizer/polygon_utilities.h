@@ -39,10 +39,17 @@
 #include <visualization_msgs/Marker.h>
 
 #include <Eigen/Dense>
+#include <array>
+#include <functional>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace hydra {
 
+class NearestNodeFinder;
+
 double getMeanChildHeight(const DynamicSceneGraph& graph, const SceneGraphNode& parent);
 
 double getMeanNeighborHeight(const SceneGraphLayer& graph,
@@ -50,6 +57,26 @@ double getMeanNeighborHeight(const SceneGraphLayer& graph,
                              double neighborhood = 10.0,
                              bool use_nearest_node_finder = false);
 
+//! Mean height of the nodes within the neighborhood, looked up in an existing index
+double getMeanNeighborHeight(const SceneGraphLayer& graph,
+                             NearestNodeFinder& finder,
+                             const SceneGraphNode& node,
+                             double neighborhood = 10.0);
+
+/**
+ * @brief Compute the mean neighbor height of every node in the layer at once
+ *
+ * By default only nodes connected to each node through edges inside the neighborhood
+ * count, matching getMeanNeighborHeight(). Each search stays inside the neighborhood,
+ * so the cost only grows with the local node density. With use_nearest_node_finder,
+ * every node within the neighborhood counts and a single spatial index over the
+ * layer is shared between the lookups instead.
+ */
+std::unordered_map<NodeId, double> getMeanNeighborHeights(
+    const SceneGraphLayer& graph,
+    double neighborhood = 10.0,
+    bool use_nearest_node_finder = false);
+
 Eigen::MatrixXd getCirclePolygon(const SceneGraphNode& node,
                                  double radius,
                                  size_t num_samples);
@@ -57,6 +84,55 @@ Eigen::MatrixXd getCirclePolygon(const SceneGraphNode& node,
 Eigen::MatrixXd getChildrenConvexHull(const DynamicSceneGraph& graph,
                                       const SceneGraphNode& parent);
 
+//! Polygon of a node and its triangulation, tagged with the node state it came from
+struct CachedPolygon {
+  size_t fingerprint = 0;
+  //! Polygon vertices (3 x N)
+  Eigen::MatrixXd points;
+  std::vector<std::array<size_t, 3>> faces;
+  //! Height to draw the polygon at (if not using the vertex heights)
+  std::optional<double> height;
+};
+
+/**
+ * @brief Polygons of the nodes in a layer that only get re-triangulated when the node
+ * changes
+ *
+ * Callers key each polygon by node id and a fingerprint of whatever the polygon
+ * depends on (position, radius, children, etc.).
+ */
+class PolygonCache {
+ public:
+  //! Fill in the polygon vertices and (optionally) height of a new or changed node
+  using PolygonFunction = std::function<void(CachedPolygon&)>;
+
+  /**
+   * @brief Get the polygon for the node, rebuilding it if the fingerprint changed
+   *
+   * Nodes not looked up since the last call to prune() are dropped by prune().
+   */
+  const CachedPolygon& get(NodeId node,
+                           size_t fingerprint,
+                           const PolygonFunction& make_polygon);
+
+  //! Drop polygons of nodes that were not looked up since the last prune
+  void prune();
+
+  void clear();
+
+  size_t size() const { return polygons_.size(); }
+
+ private:
+  std::unordered_map<NodeId, CachedPolygon> polygons_;
+  std::unordered_set<NodeId> seen_;
+};
+
+//! Append the cached triangles of a polygon to a TRIANGLE_LIST marker
+void addFilledPolygon(const CachedPolygon& polygon,
+                      const std_msgs::ColorRGBA& color,
+                      visualization_msgs::Marker& marker,
+                      std::optional<double> height = std::nullopt);
+
 void makeFilledPolygon(const Eigen::MatrixXd& points,
                        const std_msgs::ColorRGBA& color,
                        visualization_msgs::Marker& marker,
@@ -37,6 +37,7 @@
 #include <std_srvs/SetBool.h>
 
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/polygon_utilities.h"
 
 namespace hydra {
 
@@ -70,6 +71,8 @@ class RegionPlugin : public DsgVisualizerPlugin {
   ros::Publisher pub_;
   std::unique_ptr<SemanticColorMap> colormap_;
   std::set<int> published_labels_;
+  //! Hulls of the regions drawn last, rebuilt only when their children change
+  PolygonCache polygons_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
@@ -0,0 +1,263 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/frontend/gvd_distance_publisher.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/ros.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <hydra/common/global_info.h>
+
+#include <cmath>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+inline constexpr float kUnknownDistance = std::numeric_limits<float>::quiet_NaN();
+
+void declare_config(GvdDistanceGrid::Config& config) {
+  using namespace config;
+  name("GvdDistanceGrid::Config");
+  field(config.use_relative_height, "use_relative_height");
+  field(config.slice_height, "slice_height", "m");
+  field(config.num_slices, "num_slices");
+  check(config.num_slices, GT, static_cast<size_t>(0), "num_slices");
+}
+
+GvdDistanceGrid::GvdDistanceGrid(const Config& config)
+    : config(config::checkValid(config)) {
+  reset();
+}
+
+void GvdDistanceGrid::reset() {
+  voxel_size_ = 0.0f;
+  voxels_per_side_ = 0;
+  slice_index_ = 0;
+  origin_.setZero();
+  dims_.setZero();
+  distances_.clear();
+  columns_.clear();
+  regions_.clear();
+  resized_ = true;
+}
+
+size_t GvdDistanceGrid::update(const Eigen::Isometry3d& world_T_sensor,
+                               const places::GvdLayer& gvd) {
+  if (gvd.voxel_size != voxel_size_ ||
+      static_cast<int>(gvd.voxels_per_side) != voxels_per_side_) {
+    reset();
+    voxel_size_ = gvd.voxel_size;
+    voxels_per_side_ = gvd.voxels_per_side;
+  }
+
+  auto height = config.slice_height;
+  if (config.use_relative_height) {
+    height += world_T_sensor.translation().z();
+  }
+
+  const auto slice_key = gvd.getVoxelKey(Point(0, 0, height));
+  const int64_t slice_index =
+      static_cast<int64_t>(slice_key.first.z()) * voxels_per_side_ +
+      slice_key.second.z();
+  if (slice_index != slice_index_) {
+    // distances from the old band are meaningless, so clear them in place
+    std::fill(distances_.begin(), distances_.end(), kUnknownDistance);
+    columns_.clear();
+    slice_index_ = slice_index;
+    resized_ = true;
+  }
+
+  const int64_t num_slices = config.num_slices;
+  const auto min_block_z = floorDiv(slice_index, voxels_per_side_);
+  const auto max_block_z = floorDiv(slice_index + num_slices - 1, voxels_per_side_);
+  const auto changes = columns_.update(gvd, min_block_z, max_block_z);
+  std::vector<BlockIndex> changed = changes.updated;
+  changed.insert(changed.end(), changes.removed.begin(), changes.removed.end());
+
+  regions_.clear();
+  if (changed.empty()) {
+    return 0;
+  }
+
+  reserve(getColumnBounds(changed, voxels_per_side_));
+  for (const auto& column : changes.updated) {
+    fillColumn(gvd, column, false);
+  }
+
+  for (const auto& column : changes.removed) {
+    fillColumn(gvd, column, true);
+  }
+
+  regions_ = getColumnRegions(changed, voxels_per_side_, origin_);
+  return changed.size();
+}
+
+void GvdDistanceGrid::reserve(const GridRegion& cells) {
+  const GridExtent extent{origin_, dims_};
+  if (extent.contains(cells.min, cells.max)) {
+    return;
+  }
+
+  const auto new_extent = growExtent(extent, cells.min, cells.max, voxels_per_side_);
+  resizeGrid(extent, new_extent, kUnknownDistance, distances_);
+  origin_ = new_extent.min;
+  dims_ = new_extent.dims;
+  resized_ = true;
+}
+
+void GvdDistanceGrid::fillColumn(const places::GvdLayer& gvd,
+                                 const BlockIndex& column,
+                                 bool clear) {
+  const int vps = voxels_per_side_;
+  std::vector<std::pair<const places::GvdBlock*, int>> slices;
+  for (size_t i = 0; i < config.num_slices && !clear; ++i) {
+    const int64_t global_z = slice_index_ + static_cast<int64_t>(i);
+    const int block_z = floorDiv(global_z, vps);
+    const auto block = gvd.getBlockPtr(BlockIndex(column.x(), column.y(), block_z));
+    if (block) {
+      slices.emplace_back(block.get(), global_z - block_z * vps);
+    }
+  }
+
+  const Eigen::Vector2i column_origin = column.head<2>() * vps - origin_;
+  for (int y = 0; y < vps; ++y) {
+    const size_t row = (column_origin.y() + y) * dims_.x() + column_origin.x();
+    for (int x = 0; x < vps; ++x) {
+      float distance = kUnknownDistance;
+      for (const auto& [block, voxel_z] : slices) {
+        const auto& voxel = block->getVoxel(VoxelIndex(x, y, voxel_z));
+        if (voxel.observed && (std::isnan(distance) || voxel.distance < distance)) {
+          distance = voxel.distance;
+        }
+      }
+
+      distances_[row + x] = distance;
+    }
+  }
+}
+
+GridRegion GvdDistanceGrid::bounds() const {
+  return {Eigen::Vector2i::Zero(), dims_};
+}
+
+void GvdDistanceGrid::fillMsg(const GridRegion& region,
+                              hydra_msgs::FloatGrid& msg) const {
+  const Eigen::Vector2i dims = region.max - region.min;
+  msg.resolution = voxel_size_;
+  msg.origin_x = (origin_.x() + region.min.x()) * voxel_size_;
+  msg.origin_y = (origin_.y() + region.min.y()) * voxel_size_;
+  msg.width = dims.x();
+  msg.height = dims.y();
+  msg.layers = {"distance"};
+  msg.data.clear();
+  msg.data.reserve(dims.x() * dims.y());
+  for (int r = region.min.y(); r < region.max.y(); ++r) {
+    const auto row = distances_.begin() + r * dims_.x();
+    msg.data.insert(msg.data.end(), row + region.min.x(), row + region.max.x());
+  }
+}
+
+void declare_config(GvdDistancePublisher::Config& config) {
+  using namespace config;
+  name("GvdDistancePublisher::Config");
+  field(config.ns, "ns");
+  field(config.extraction, "extraction");
+  field(config.full_grid_period_s, "full_grid_period_s", "s");
+  check(config.full_grid_period_s, GE, 0.0, "full_grid_period_s");
+}
+
+GvdDistancePublisher::GvdDistancePublisher(const Config& config)
+    : config(config::checkValid(config)),
+      nh_(config.ns),
+      grid_(std::make_unique<GvdDistanceGrid>(config.extraction)),
+      send_full_grid_(true),
+      last_full_grid_ns_(0) {
+  // late subscribers only have the last (latched) full grid, so send a new one
+  pub_ = nh_.advertise<hydra_msgs::FloatGrid>(
+      "distance",
+      1,
+      [this](const ros::SingleSubscriberPublisher&) { send_full_grid_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      true);
+  update_pub_ = nh_.advertise<hydra_msgs::FloatGrid>("distance_updates", 10);
+}
+
+void GvdDistancePublisher::call(uint64_t timestamp_ns,
+                                const Eigen::Isometry3f& world_T_body,
+                                const places::GvdLayer& gvd,
+                                const places::GraphExtractorInterface*) const {
+  if (pub_.getNumSubscribers() == 0 && update_pub_.getNumSubscribers() == 0) {
+    // we can't track changes without updating, so rebuild when someone subscribes
+    grid_->reset();
+    return;
+  }
+
+  grid_->update(world_T_body.cast<double>(), gvd);
+
+  std_msgs::Header header;
+  header.frame_id = GlobalInfo::instance().getFrames().map;
+  header.stamp.fromNSec(timestamp_ns);
+
+  const auto elapsed_s = (timestamp_ns - last_full_grid_ns_) * 1.0e-9;
+  const bool period_elapsed =
+      config.full_grid_period_s > 0.0 && elapsed_s >= config.full_grid_period_s;
+  if (send_full_grid_.exchange(false) || grid_->resized() || period_elapsed) {
+    if (pub_.getNumSubscribers() > 0) {
+      hydra_msgs::FloatGrid msg;
+      msg.header = header;
+      grid_->fillMsg(grid_->bounds(), msg);
+      pub_.publish(msg);
+    }
+
+    grid_->clearResized();
+    last_full_grid_ns_ = timestamp_ns;
+  }
+
+  // updates carry their own origin, so they stay valid across full grids and resizes
+  if (update_pub_.getNumSubscribers() == 0) {
+    return;
+  }
+
+  for (const auto& region : grid_->changedRegions()) {
+    hydra_msgs::FloatGrid msg;
+    msg.header = header;
+    grid_->fillMsg(region, msg);
+    update_pub_.publish(msg);
+  }
+}
+
+}  // namespace hydra
@@ -166,6 +166,7 @@ void PlacesVisualizer::visualizeGraph(const std_msgs::Header& header,
 
   pubs_->publish("graph_viz", [&](MarkerArray& markers) {
     const std::string node_ns = config_.place_marker_ns + "_nodes";
+    const auto& colormap = dsg_utils::getColormapLut(config_.colormap);
     Marker node_marker = makeCentroidMarkers(
         header,
         config_.graph_layer,
@@ -174,7 +175,7 @@ void PlacesVisualizer::visualizeGraph(const std_msgs::Header& header,
         node_ns,
         [&](const SceneGraphNode& node) {
           return getDistanceColor(config_.graph,
-                                  config_.colormap,
+                                  colormap,
                                   node.attributes<PlaceNodeAttributes>().distance);
         });
     markers.markers.push_back(node_marker);
@@ -53,6 +53,7 @@
 #include "hydra_ros/backend/ros_backend_publisher.h"
 #include "hydra_ros/frontend/ros_frontend_publisher.h"
 #include "hydra_ros/loop_closure/ros_lcd_registration.h"
+#include "hydra_ros/reconstruction/tsdf_raycast_server.h"
 #include "hydra_ros/utils/bow_subscriber.h"
 
 namespace hydra {
@@ -61,6 +62,7 @@ void declare_config(HydraRosConfig& conf) {
   using namespace config;
   name("HydraRosConfig");
   field(conf.enable_frontend_output, "enable_frontend_output");
+  field(conf.enable_raycast_service, "enable_raycast_service");
   field(conf.input, "input");
 }
 
@@ -135,8 +137,15 @@ void HydraRosPipeline::initReconstruction() {
   }
 
   ros::NodeHandle rnh(nh_, "reconstruction");
-  modules_["reconstruction"] =
+  ReconstructionModule::Ptr reconstruction =
       config::createFromROS<ReconstructionModule>(rnh, frontend->getQueue());
+  if (reconstruction && config_.enable_raycast_service) {
+    auto raycast_config = config::fromRos<TsdfRaycastServer::Config>(rnh);
+    raycast_config.ns = rnh.getNamespace();
+    reconstruction->addSink(std::make_shared<TsdfRaycastServer>(raycast_config));
+  }
+
+  modules_["reconstruction"] = reconstruction;
 }
 
 void HydraRosPipeline::initLCD() {
@@ -0,0 +1,318 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/reconstruction/elevation_publisher.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/ros.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <hydra/common/global_info.h>
+
+#include <array>
+#include <cmath>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+inline constexpr float kUnknown = std::numeric_limits<float>::quiet_NaN();
+
+void declare_config(ElevationMap::Config& config) {
+  using namespace config;
+  name("ElevationMap::Config");
+  field(config.min_observation_weight, "min_observation_weight");
+}
+
+ElevationMap::ElevationMap(const Config& config)
+    : config(config::checkValid(config)),
+      voxel_size_(0.0f),
+      voxels_per_side_(0),
+      origin_(Eigen::Vector2i::Zero()),
+      dims_(Eigen::Vector2i::Zero()),
+      resized_(false) {}
+
+size_t ElevationMap::update(const TsdfLayer& layer) {
+  if (layer.voxel_size != voxel_size_ ||
+      static_cast<int>(layer.voxels_per_side) != voxels_per_side_) {
+    voxel_size_ = layer.voxel_size;
+    voxels_per_side_ = layer.voxels_per_side;
+    origin_.setZero();
+    dims_.setZero();
+    ground_.clear();
+    step_.clear();
+    slope_.clear();
+    columns_.clear();
+    resized_ = true;
+  }
+
+  int min_block_z = std::numeric_limits<int>::max();
+  int max_block_z = std::numeric_limits<int>::lowest();
+  for (const auto& block : layer) {
+    min_block_z = std::min(min_block_z, block.index.z());
+    max_block_z = std::max(max_block_z, block.index.z());
+  }
+
+  // removed columns are ignored so that the map keeps what left the TSDF
+  const auto dirty = columns_.update(layer, min_block_z, max_block_z).updated;
+  regions_.clear();
+  if (dirty.empty()) {
+    return 0;
+  }
+
+  reserve(getColumnBounds(dirty, voxels_per_side_));
+  for (const auto& column : dirty) {
+    updateColumn(layer, column, min_block_z, max_block_z);
+  }
+
+  // step and slope depend on neighboring heights, so grow each region by a cell
+  for (auto region : getColumnRegions(dirty, voxels_per_side_, origin_)) {
+    region.min = (region.min - Eigen::Vector2i::Ones()).cwiseMax(0);
+    region.max = (region.max + Eigen::Vector2i::Ones()).cwiseMin(dims_);
+    updateDerived(region);
+    regions_.push_back(region);
+  }
+
+  return dirty.size();
+}
+
+void ElevationMap::reserve(const GridRegion& cells) {
+  const GridExtent extent{origin_, dims_};
+  if (extent.contains(cells.min, cells.max)) {
+    return;
+  }
+
+  const auto new_extent = growExtent(extent, cells.min, cells.max, voxels_per_side_);
+  for (auto* values : {&ground_, &step_, &slope_}) {
+    resizeGrid(extent, new_extent, kUnknown, *values);
+  }
+
+  origin_ = new_extent.min;
+  dims_ = new_extent.dims;
+  resized_ = true;
+}
+
+void ElevationMap::updateColumn(const TsdfLayer& layer,
+                                const BlockIndex& column,
+                                int min_block_z,
+                                int max_block_z) {
+  std::vector<const TsdfBlock*> blocks;
+  for (int z = min_block_z; z <= max_block_z; ++z) {
+    const auto block = layer.getBlockPtr(BlockIndex(column.x(), column.y(), z));
+    blocks.push_back(block.get());
+  }
+
+  const Eigen::Vector2i column_origin = column.head<2>() * voxels_per_side_ - origin_;
+  for (int y = 0; y < voxels_per_side_; ++y) {
+    for (int x = 0; x < voxels_per_side_; ++x) {
+      // the ground is the lowest observed crossing from inside (below) to free (above)
+      float ground = kUnknown;
+      bool has_below = false;
+      float distance_below = 0.0f;
+      float z_below = 0.0f;
+      for (size_t i = 0; i < blocks.size() && std::isnan(ground); ++i) {
+        const auto block = blocks[i];
+        if (!block) {
+          has_below = false;
+          continue;
+        }
+
+        for (int z = 0; z < voxels_per_side_; ++z) {
+          const VoxelIndex voxel_index(x, y, z);
+          const auto& voxel = block->getVoxel(voxel_index);
+          if (voxel.weight < config.min_observation_weight) {
+            has_below = false;
+            continue;
+          }
+
+          const float z_curr = block->getVoxelPosition(voxel_index).z();
+          if (has_below && distance_below <= 0.0f && voxel.distance > 0.0f) {
+            // interpolate the zero crossing between the two voxel centers
+            const float ratio = distance_below / (distance_below - voxel.distance);
+            ground = z_below + ratio * voxel_size_;
+            break;
+          }
+
+          has_below = true;
+          distance_below = voxel.distance;
+          z_below = z_curr;
+        }
+      }
+
+      // the column changed, so ground that is no longer observed is unknown
+      ground_[(column_origin.y() + y) * dims_.x() + column_origin.x() + x] = ground;
+    }
+  }
+}
+
+void ElevationMap::updateDerived(const GridRegion& region) {
+  const auto height = [&](int r, int c) -> float {
+    if (r < 0 || c < 0 || r >= dims_.y() || c >= dims_.x()) {
+      return kUnknown;
+    }
+
+    return ground_[r * dims_.x() + c];
+  };
+
+  for (int r = region.min.y(); r < region.max.y(); ++r) {
+    for (int c = region.min.x(); c < region.max.x(); ++c) {
+      const size_t index = r * dims_.x() + c;
+      const float center = ground_[index];
+      if (std::isnan(center)) {
+        step_[index] = kUnknown;
+        slope_[index] = kUnknown;
+        continue;
+      }
+
+      float step = 0.0f;
+      for (int dr = -1; dr <= 1; ++dr) {
+        for (int dc = -1; dc <= 1; ++dc) {
+          const float neighbor = height(r + dr, c + dc);
+          if (!std::isnan(neighbor)) {
+            step = std::max(step, std::abs(neighbor - center));
+          }
+        }
+      }
+
+      // central differences where possible, one-sided otherwise
+      Eigen::Vector2f gradient = Eigen::Vector2f::Zero();
+      const std::array<std::pair<int, int>, 2> axes{{{0, 1}, {1, 0}}};
+      for (size_t i = 0; i < axes.size(); ++i) {
+        const auto [dr, dc] = axes[i];
+        const float next = height(r + dr, c + dc);
+        const float prev = height(r - dr, c - dc);
+        if (!std::isnan(next) && !std::isnan(prev)) {
+          gradient(i) = (next - prev) / (2.0f * voxel_size_);
+        } else if (!std::isnan(next)) {
+          gradient(i) = (next - center) / voxel_size_;
+        } else if (!std::isnan(prev)) {
+          gradient(i) = (center - prev) / voxel_size_;
+        }
+      }
+
+      step_[index] = step;
+      slope_[index] = std::atan(gradient.norm());
+    }
+  }
+}
+
+GridRegion ElevationMap::bounds() const {
+  return {Eigen::Vector2i::Zero(), dims_};
+}
+
+void ElevationMap::fillMsg(const GridRegion& region,
+                           hydra_msgs::FloatGrid& msg) const {
+  const Eigen::Vector2i dims = region.max - region.min;
+  msg.resolution = voxel_size_;
+  msg.origin_x = (origin_.x() + region.min.x()) * voxel_size_;
+  msg.origin_y = (origin_.y() + region.min.y()) * voxel_size_;
+  msg.width = dims.x();
+  msg.height = dims.y();
+  msg.layers = {"ground_height", "step_height", "slope"};
+  msg.data.clear();
+  msg.data.reserve(3 * dims.x() * dims.y());
+  for (const auto* values : {&ground_, &step_, &slope_}) {
+    for (int r = region.min.y(); r < region.max.y(); ++r) {
+      const auto row = values->begin() + r * dims_.x();
+      msg.data.insert(msg.data.end(), row + region.min.x(), row + region.max.x());
+    }
+  }
+}
+
+void declare_config(ElevationPublisher::Config& config) {
+  using namespace config;
+  name("ElevationPublisher::Config");
+  field(config.ns, "ns");
+  field(config.map, "map");
+  field(config.full_map_period_s, "full_map_period_s", "s");
+  check(config.full_map_period_s, GE, 0.0, "full_map_period_s");
+}
+
+ElevationPublisher::ElevationPublisher(const Config& config)
+    : config(config::checkValid(config)),
+      nh_(config.ns),
+      map_(std::make_unique<ElevationMap>(config.map)),
+      send_full_map_(true),
+      last_full_map_ns_(0) {
+  // late subscribers only have the last (latched) full map, so send a new one
+  pub_ = nh_.advertise<hydra_msgs::FloatGrid>(
+      "elevation",
+      1,
+      [this](const ros::SingleSubscriberPublisher&) { send_full_map_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      true);
+  update_pub_ = nh_.advertise<hydra_msgs::FloatGrid>("elevation_updates", 10);
+}
+
+void ElevationPublisher::call(uint64_t timestamp_ns,
+                              const Eigen::Isometry3d&,
+                              const TsdfLayer& tsdf,
+                              const ReconstructionOutput&) const {
+  // the map only keeps what it has seen, so it is updated even without subscribers
+  map_->update(tsdf);
+
+  std_msgs::Header header;
+  header.frame_id = GlobalInfo::instance().getFrames().map;
+  header.stamp.fromNSec(timestamp_ns);
+
+  const auto elapsed_s = (timestamp_ns - last_full_map_ns_) * 1.0e-9;
+  const bool period_elapsed =
+      config.full_map_period_s > 0.0 && elapsed_s >= config.full_map_period_s;
+  if (send_full_map_.exchange(false) || map_->resized() || period_elapsed) {
+    if (pub_.getNumSubscribers() > 0) {
+      hydra_msgs::FloatGrid msg;
+      msg.header = header;
+      map_->fillMsg(map_->bounds(), msg);
+      pub_.publish(msg);
+    }
+
+    map_->clearResized();
+    last_full_map_ns_ = timestamp_ns;
+  }
+
+  // updates carry their own origin, so they stay valid across full maps and resizes
+  if (update_pub_.getNumSubscribers() == 0) {
+    return;
+  }
+
+  for (const auto& region : map_->changedRegions()) {
+    hydra_msgs::FloatGrid msg;
+    msg.header = header;
+    map_->fillMsg(region, msg);
+    update_pub_.publish(msg);
+  }
+}
+
+}  // namespace hydra
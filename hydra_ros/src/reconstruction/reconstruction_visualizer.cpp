@@ -49,23 +49,24 @@ using visualization_msgs::Marker;
 using visualization_msgs::MarkerArray;
 using VizConfig = ReconstructionVisualizer::Config;
 
-using ColorFunction =
-    std::function<std_msgs::ColorRGBA(const VizConfig&, const TsdfVoxel&)>;
+using ColorFunction = std::function<std_msgs::ColorRGBA(
+    const VizConfig&, const dsg_utils::ColormapLut&, const TsdfVoxel&)>;
 
-std_msgs::ColorRGBA colorVoxelByDist(const VizConfig& config, const TsdfVoxel& voxel) {
+std_msgs::ColorRGBA colorVoxelByDist(const VizConfig& config,
+                                     const dsg_utils::ColormapLut& colormap,
+                                     const TsdfVoxel& voxel) {
   double ratio =
       dsg_utils::computeRatio(config.min_distance, config.max_distance, voxel.distance);
-  auto color = dsg_utils::interpolateColorMap(config.colors, ratio);
-  return dsg_utils::makeColorMsg(color, config.marker_alpha);
+  return colormap.getColorMsg(ratio, config.marker_alpha);
 }
 
 std_msgs::ColorRGBA colorVoxelByWeight(const VizConfig& config,
+                                       const dsg_utils::ColormapLut& colormap,
                                        const TsdfVoxel& voxel) {
   // TODO(nathan) consider exponential
   double ratio =
       dsg_utils::computeRatio(config.min_weight, config.max_weight, voxel.weight);
-  auto color = dsg_utils::interpolateColorMap(config.colors, ratio);
-  return dsg_utils::makeColorMsg(color, config.marker_alpha);
+  return colormap.getColorMsg(ratio, config.marker_alpha);
 }
 
 // adapted from khronos
@@ -101,6 +102,8 @@ Marker makeTsdfMarker(const VizConfig& config,
   const auto grid_index = spatial_hash::indexFromPoint<VoxelIndex>(
       slice_pos - origin, layer.voxel_size_inv);
 
+  // looked up once per marker instead of once per voxel
+  const auto& colormap = dsg_utils::getColormapLut(config.colors);
   for (const auto& block : layer) {
     if (block.index.z() != slice_index.z()) {
       continue;
@@ -119,7 +122,7 @@ Marker makeTsdfMarker(const VizConfig& config,
         geometry_msgs::Point marker_pos;
         tf2::convert(pos, marker_pos);
         msg.points.push_back(marker_pos);
-        msg.colors.push_back(color_func(config, voxel));
+        msg.colors.push_back(color_func(config, colormap, voxel));
       }
     }
   }
@@ -0,0 +1,310 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/reconstruction/tsdf_raycast_server.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+// avoid paying for thread startup when only a few rays are requested
+constexpr size_t kMinRaysPerThread = 16;
+
+TsdfSnapshot::TsdfSnapshot(float voxel_size, size_t voxels_per_side)
+    : voxel_size(voxel_size), voxels_per_side(voxels_per_side) {}
+
+TsdfSnapshot::Ptr TsdfSnapshot::update(const Ptr& prev, const TsdfLayer& layer) {
+  auto snapshot = std::make_shared<TsdfSnapshot>(layer.voxel_size, layer.voxels_per_side);
+  if (prev && prev->voxel_size == snapshot->voxel_size &&
+      prev->voxels_per_side == snapshot->voxels_per_side) {
+    for (const auto& [index, block] : prev->blocks_) {
+      if (layer.hasBlock(index)) {
+        snapshot->blocks_.emplace(index, block);
+      }
+    }
+  }
+
+  for (const auto& block : layer) {
+    auto iter = snapshot->blocks_.find(block.index);
+    if (iter == snapshot->blocks_.end()) {
+      snapshot->blocks_.emplace(block.index, std::make_shared<const TsdfBlock>(block));
+    } else if (block.updated) {
+      iter->second = std::make_shared<const TsdfBlock>(block);
+    }
+  }
+
+  return snapshot;
+}
+
+const TsdfBlock* TsdfSnapshot::getBlock(const BlockIndex& index) const {
+  auto iter = blocks_.find(index);
+  return iter == blocks_.end() ? nullptr : iter->second.get();
+}
+
+const TsdfVoxel* TsdfSnapshot::getVoxel(const GlobalIndex& index) const {
+  const int64_t vps = voxels_per_side;
+  const BlockIndex block_index(
+      floorDiv(index.x(), vps), floorDiv(index.y(), vps), floorDiv(index.z(), vps));
+  const auto block = getBlock(block_index);
+  if (!block) {
+    return nullptr;
+  }
+
+  const GlobalIndex voxel_index = index - block_index.cast<int64_t>() * vps;
+  return &block->getVoxel(VoxelIndex(voxel_index.cast<int>()));
+}
+
+void declare_config(TsdfRaycaster::Config& config) {
+  using namespace config;
+  name("TsdfRaycaster::Config");
+  field(config.min_observation_weight, "min_observation_weight");
+  field(config.surface_distance, "surface_distance", "m");
+  field(config.max_range, "max_range", "m");
+  field(config.num_threads, "num_threads");
+  check(config.max_range, GT, 0.0, "max_range");
+  check(config.num_threads, GT, static_cast<size_t>(0), "num_threads");
+}
+
+TsdfRaycaster::TsdfRaycaster(const Config& config)
+    : config(config::checkValid(config)) {}
+
+bool isValidRay(const Eigen::Vector3d& origin, const Eigen::Vector3d& endpoint) {
+  const double length = (endpoint - origin).norm();
+  return origin.allFinite() && endpoint.allFinite() && std::isfinite(length) &&
+         length > 0.0;
+}
+
+RayResult TsdfRaycaster::cast(const TsdfSnapshot& tsdf,
+                              const Eigen::Vector3d& origin,
+                              const Eigen::Vector3d& ray_end) const {
+  if (!isValidRay(origin, ray_end)) {
+    return {};
+  }
+
+  // the number of voxels visited grows with the length, so bound it
+  const double length = std::min((ray_end - origin).norm(), config.max_range);
+  const Eigen::Vector3d endpoint =
+      origin + (ray_end - origin).normalized() * length;
+
+  // Amanatides & Woo traversal in voxel units, parameterized by t in [0, 1]
+  const Eigen::Vector3d start = origin / tsdf.voxel_size;
+  const Eigen::Vector3d dir = (endpoint - origin) / tsdf.voxel_size;
+  const double max_index = std::numeric_limits<int>::max();
+  if ((start.cwiseAbs().array() + dir.cwiseAbs().array() >= max_index).any()) {
+    // block indices along the ray wouldn't fit in an int
+    return {};
+  }
+
+  GlobalIndex curr = start.array().floor().cast<int64_t>();
+  const GlobalIndex last =
+      (endpoint / tsdf.voxel_size).array().floor().cast<int64_t>();
+  Eigen::Vector3i step;
+  Eigen::Vector3d t_max;
+  Eigen::Vector3d t_delta;
+  for (int i = 0; i < 3; ++i) {
+    if (dir(i) == 0.0) {
+      step(i) = 0;
+      t_max(i) = std::numeric_limits<double>::infinity();
+      t_delta(i) = std::numeric_limits<double>::infinity();
+      continue;
+    }
+
+    step(i) = dir(i) > 0.0 ? 1 : -1;
+    const double boundary = curr(i) + (step(i) > 0 ? 1 : 0);
+    t_max(i) = (boundary - start(i)) / dir(i);
+    t_delta(i) = std::abs(1.0 / dir(i));
+  }
+
+  const int64_t vps = tsdf.voxels_per_side;
+  BlockIndex block_index;
+  const TsdfBlock* block = nullptr;
+  bool have_block = false;
+
+  RayResult result;
+  const size_t num_steps = (last - curr).cwiseAbs().sum() + 1;
+  double t = 0.0;
+  for (size_t n = 0; n < num_steps; ++n) {
+    const BlockIndex curr_block(
+        floorDiv(curr.x(), vps), floorDiv(curr.y(), vps), floorDiv(curr.z(), vps));
+    if (!have_block || curr_block != block_index) {
+      block_index = curr_block;
+      block = tsdf.getBlock(block_index);
+      have_block = true;
+    }
+
+    const TsdfVoxel* voxel = nullptr;
+    if (block) {
+      const GlobalIndex local = curr - block_index.cast<int64_t>() * vps;
+      voxel = &block->getVoxel(VoxelIndex(local.cast<int>()));
+    }
+
+    if (!voxel || voxel->weight < config.min_observation_weight) {
+      ++result.num_unknown;
+    } else if (voxel->distance <= config.surface_distance) {
+      result.hit_distance = t * length;
+      break;
+    }
+
+    int axis;
+    t_max.minCoeff(&axis);
+    t = t_max(axis);
+    if (t > 1.0) {
+      break;
+    }
+
+    curr(axis) += step(axis);
+    t_max(axis) += t_delta(axis);
+  }
+
+  return result;
+}
+
+std::vector<RayResult> TsdfRaycaster::castAll(
+    const TsdfSnapshot& tsdf,
+    const std::vector<Eigen::Vector3d>& origins,
+    const std::vector<Eigen::Vector3d>& endpoints) const {
+  CHECK_EQ(origins.size(), endpoints.size());
+  std::vector<RayResult> results(origins.size());
+
+  // rays can vary a lot in length, so hand them out one at a time
+  std::atomic<size_t> next(0);
+  const auto worker = [&]() {
+    size_t i;
+    while ((i = next++) < origins.size()) {
+      results[i] = cast(tsdf, origins[i], endpoints[i]);
+    }
+  };
+
+  const size_t num_threads =
+      std::min(config.num_threads, origins.size() / kMinRaysPerThread);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return results;
+}
+
+void declare_config(TsdfRaycastServer::Config& config) {
+  using namespace config;
+  name("TsdfRaycastServer::Config");
+  field(config.ns, "ns");
+  field(config.raycaster, "raycaster");
+}
+
+TsdfRaycastServer::TsdfRaycastServer(const Config& config)
+    : config(config), raycaster_(config.raycaster), nh_(config.ns) {
+  service_ =
+      nh_.advertiseService("raycast_tsdf", &TsdfRaycastServer::handleRaycast, this);
+}
+
+void TsdfRaycastServer::call(uint64_t,
+                             const Eigen::Isometry3d&,
+                             const TsdfLayer& tsdf,
+                             const ReconstructionOutput&) const {
+  // build the new snapshot outside the lock so queries only wait for the swap
+  TsdfSnapshot::Ptr prev;
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    prev = snapshot_;
+  }
+
+  auto snapshot = TsdfSnapshot::update(prev, tsdf);
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  snapshot_ = snapshot;
+}
+
+bool TsdfRaycastServer::handleRaycast(hydra_msgs::RaycastTsdf::Request& req,
+                                      hydra_msgs::RaycastTsdf::Response& res) {
+  if (req.origins.size() != req.endpoints.size() || req.origins.size() % 3 != 0) {
+    LOG(ERROR) << "Invalid raycast request: " << req.origins.size() << " origin and "
+               << req.endpoints.size() << " endpoint coordinates";
+    res.success = false;
+    return true;
+  }
+
+  TsdfSnapshot::Ptr snapshot;
+  {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    snapshot = snapshot_;
+  }
+
+  if (!snapshot) {
+    LOG(WARNING) << "No TSDF received yet";
+    res.success = false;
+    return true;
+  }
+
+  const size_t num_rays = req.origins.size() / 3;
+  std::vector<Eigen::Vector3d> origins(num_rays);
+  std::vector<Eigen::Vector3d> endpoints(num_rays);
+  for (size_t i = 0; i < num_rays; ++i) {
+    origins[i] = Eigen::Map<const Eigen::Vector3d>(req.origins.data() + 3 * i);
+    endpoints[i] = Eigen::Map<const Eigen::Vector3d>(req.endpoints.data() + 3 * i);
+    if (!isValidRay(origins[i], endpoints[i])) {
+      LOG(ERROR) << "Invalid raycast request: ray " << i
+                 << " is not finite or has zero length";
+      res.success = false;
+      return true;
+    }
+  }
+
+  const auto results = raycaster_.castAll(*snapshot, origins, endpoints);
+  res.hit_distance.resize(num_rays);
+  res.num_unknown.resize(num_rays);
+  for (size_t i = 0; i < num_rays; ++i) {
+    res.hit_distance[i] = results[i].hit_distance;
+    res.num_unknown[i] = results[i].num_unknown;
+  }
+
+  res.success = true;
+  return true;
+}
+
+}  // namespace hydra
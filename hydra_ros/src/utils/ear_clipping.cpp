@@ -37,6 +37,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <limits>
 #include <numeric>
 
 namespace hydra {
@@ -125,29 +127,19 @@ std::array<size_t, 3> TriangleView::face() const {
   }
 }
 
-template <typename T>
-typename T::const_iterator getPrevIter(const T& vec, typename T::const_iterator iter) {
-  if (vec.empty()) {
-    return vec.begin();
-  }
+namespace {
 
-  const auto last_valid = std::prev(vec.end());
-  return iter == vec.begin() ? last_valid : std::prev(iter);
-}
+inline constexpr size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
 
-template <typename T>
-typename T::const_iterator getNextIter(const T& vec, typename T::const_iterator iter) {
-  if (vec.empty()) {
-    return vec.begin();
-  }
+struct EarCandidate {
+  double cosine;
+  size_t index;
+};
 
-  const auto niter = std::next(iter);
-  return niter == vec.end() ? vec.begin() : niter;
-}
+}  // namespace
 
-TriangleIter::TriangleIter(const Polygon* polygon,
-                           std::list<size_t>::const_iterator iter)
-    : polygon_(polygon), iter_(iter) {
+TriangleIter::TriangleIter(const Polygon* polygon, size_t index)
+    : polygon_(polygon), index_(index) {
   setView();
 }
 
@@ -156,7 +148,8 @@ TriangleIter::reference TriangleIter::operator*() const { return view_; }
 TriangleIter::pointer TriangleIter::operator->() const { return &view_; }
 
 TriangleIter& TriangleIter::operator++() {
-  ++iter_;
+  const auto next = polygon_->next_[index_];
+  index_ = next == polygon_->head_ ? INVALID_INDEX : next;
   setView();
   return *this;
 }
@@ -168,59 +161,108 @@ TriangleIter TriangleIter::operator++(int) {
 }
 
 TriangleIter TriangleIter::next() const {
-  return TriangleIter(polygon_, getNextIter(polygon_->active(), iter_));
+  return TriangleIter(polygon_, polygon_->next_[index_]);
 }
 
 TriangleIter TriangleIter::prev() const {
-  return TriangleIter(polygon_, getPrevIter(polygon_->active(), iter_));
+  return TriangleIter(polygon_, polygon_->prev_[index_]);
 }
 
 bool operator==(const TriangleIter& lhs, const TriangleIter& rhs) {
-  return lhs.iter_ == rhs.iter_;
+  return lhs.index_ == rhs.index_;
 }
 
 bool operator!=(const TriangleIter& lhs, const TriangleIter& rhs) {
-  return lhs.iter_ != rhs.iter_;
+  return lhs.index_ != rhs.index_;
 }
 
 void TriangleIter::setView() {
-  const auto& active = polygon_->active();
-  if (iter_ == active.end()) {
+  if (index_ == INVALID_INDEX) {
     view_ = TriangleView{};
     return;
   }
 
-  const auto piter = getPrevIter(active, iter_);
-  const auto niter = getNextIter(active, iter_);
-  view_.v0 = polygon_->vertex(*piter);
-  view_.v1 = polygon_->vertex(*iter_);
-  view_.v2 = polygon_->vertex(*niter);
+  view_.v0 = polygon_->vertex(polygon_->prev_[index_]);
+  view_.v1 = polygon_->vertex(index_);
+  view_.v2 = polygon_->vertex(polygon_->next_[index_]);
 }
 
 Polygon::Polygon(const std::vector<Vertex>& vertices, bool is_ccw)
-    : is_ccw_(is_ccw), active_(vertices.size()), vertices_(vertices) {
-  std::iota(active_.begin(), active_.end(), 0);
+    : is_ccw_(is_ccw),
+      vertices_(vertices),
+      head_(vertices.empty() ? INVALID_INDEX : 0),
+      num_active_(vertices.size()),
+      prev_(vertices.size()),
+      next_(vertices.size()),
+      is_active_(vertices.size(), true),
+      is_reflex_(vertices.size(), false) {
+  const auto num_vertices = vertices_.size();
+  for (size_t i = 0; i < num_vertices; ++i) {
+    prev_[i] = i == 0 ? num_vertices - 1 : i - 1;
+    next_[i] = i + 1 == num_vertices ? 0 : i + 1;
+  }
+
   if (vertices_.size() <= 1) {
     return;
   }
 
   filter();
+  for (const auto& triangle : *this) {
+    is_reflex_[triangle.v1 - vertices_.data()] = !triangle.isConvex(is_ccw_);
+  }
+
+  makeGrid();
   VLOG(10) << "counter clockwise: " << std::boolalpha << is_ccw_;
 }
 
 void Polygon::filter() {
-  auto iter = active_.begin();
-  while (iter != active_.end()) {
-    auto next = getNextIter(active_, iter);
-    const auto norm = (vertices_.at(*iter).pos - vertices_.at(*next).pos).norm();
+  // vertices are visited in polygon order, dropping any vertex that coincides with
+  // the next remaining one
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    const auto norm = (vertices_[i].pos - vertices_[next_[i]].pos).norm();
     if (norm < 1.0e-6) {
-      iter = active_.erase(iter);
-    } else {
-      ++iter;
+      erase(TriangleIter(this, i));
     }
   }
 }
 
+void Polygon::makeGrid() {
+  Eigen::Vector2d min = vertices_.front().pos;
+  Eigen::Vector2d max = vertices_.front().pos;
+  for (const auto& vertex : vertices_) {
+    min = min.cwiseMin(vertex.pos);
+    max = max.cwiseMax(vertex.pos);
+  }
+
+  // roughly one vertex per cell
+  const Eigen::Vector2d extent = (max - min).cwiseMax(1.0e-9);
+  cell_size_ = std::sqrt(extent.x() * extent.y() / vertices_.size());
+  cell_size_ = std::max(cell_size_, extent.maxCoeff() / vertices_.size());
+  grid_origin_ = min;
+  grid_dims_ = (extent / cell_size_).array().floor().cast<int>() + 1;
+
+  std::vector<size_t> cells(vertices_.size());
+  cell_offsets_.assign(grid_dims_.prod() + 1, 0);
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    const auto cell = getCell(vertices_[i].pos);
+    cells[i] = cell.x() * grid_dims_.y() + cell.y();
+    ++cell_offsets_[cells[i] + 1];
+  }
+
+  std::partial_sum(cell_offsets_.begin(), cell_offsets_.end(), cell_offsets_.begin());
+  auto insert_pos = cell_offsets_;
+  cell_vertices_.resize(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    cell_vertices_[insert_pos[cells[i]]++] = i;
+  }
+}
+
+Eigen::Array2i Polygon::getCell(const Eigen::Vector2d& pos) const {
+  const Eigen::Array2i cell =
+      ((pos - grid_origin_) / cell_size_).array().floor().cast<int>();
+  return cell.max(0).min(grid_dims_ - 1);
+}
+
 Polygon Polygon::fromSceneGraph(const DynamicSceneGraph& graph,
                                 const std::vector<NodeId>& vertex_nodes) {
   size_t id = 0;
@@ -244,19 +286,42 @@ Polygon Polygon::fromPoints(const Eigen::MatrixXd& points) {
 }
 
 TriangleIter Polygon::erase(TriangleIter iter) {
-  auto niter = active_.erase(iter.iter_);
-  if (niter == active_.end()) {
-    niter = active_.begin();
+  const auto idx = iter.index_;
+  const auto prev = prev_[idx];
+  const auto next = next_[idx];
+  is_active_[idx] = false;
+  --num_active_;
+  if (num_active_ == 0) {
+    head_ = INVALID_INDEX;
+    return end();
+  }
+
+  next_[prev] = next;
+  prev_[next] = prev;
+  if (idx == head_) {
+    head_ = next;
   }
 
-  return TriangleIter(this, niter);
+  return TriangleIter(this, next);
 }
 
-TriangleIter Polygon::begin() const { return TriangleIter(this, active_.begin()); }
+void Polygon::updateReflex(size_t idx) {
+  is_reflex_[idx] = !TriangleIter(this, idx)->isConvex(is_ccw_);
+}
+
+TriangleIter Polygon::begin() const { return TriangleIter(this, head_); }
+
+TriangleIter Polygon::end() const { return TriangleIter(this, INVALID_INDEX); }
 
-TriangleIter Polygon::end() const { return TriangleIter(this, active_.end()); }
+std::vector<size_t> Polygon::active() const {
+  std::vector<size_t> indices;
+  indices.reserve(num_active_);
+  for (auto iter = begin(); iter != end(); ++iter) {
+    indices.push_back(iter.index_);
+  }
 
-const std::list<size_t>& Polygon::active() const { return active_; }
+  return indices;
+}
 
 const Vertex* Polygon::vertex(size_t idx) const {
   if (idx >= vertices_.size()) {
@@ -266,70 +331,49 @@ const Vertex* Polygon::vertex(size_t idx) const {
   return &vertices_[idx];
 }
 
-size_t Polygon::size() const { return active_.size(); }
+size_t Polygon::size() const { return num_active_; }
 
 bool Polygon::isEar(const TriangleView& triangle) const {
   if (!triangle.isConvex(is_ccw_)) {
     return false;
   }
 
-  for (const auto& other : *this) {
-    if (other.adjacent(triangle)) {
-      continue;
-    }
-
-    if (other.isConvex(is_ccw_)) {
-      continue;
-    }
-
-    if (triangle.isInside(other.v1->pos)) {
-      return false;
+  // only reflex vertices can lie inside a convex triangle, and only those in the
+  // cells overlapping it need checking (isInside accepts the parallelogram spanned by
+  // the triangle edges at v1, so the search region has to cover all of it)
+  const auto& p0 = triangle.v0->pos;
+  const auto& p1 = triangle.v1->pos;
+  const auto& p2 = triangle.v2->pos;
+  const Eigen::Vector2d p3 = p0 + p2 - p1;
+  // padded so that rounding in p3 can't drop vertices right on the boundary
+  const Eigen::Vector2d pad = Eigen::Vector2d::Constant(1.0e-6 * cell_size_);
+  const auto min_cell = getCell(p0.cwiseMin(p1).cwiseMin(p2).cwiseMin(p3) - pad);
+  const auto max_cell = getCell(p0.cwiseMax(p1).cwiseMax(p2).cwiseMax(p3) + pad);
+  for (int x = min_cell.x(); x <= max_cell.x(); ++x) {
+    for (int y = min_cell.y(); y <= max_cell.y(); ++y) {
+      const size_t cell = x * grid_dims_.y() + y;
+      for (size_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+        const auto idx = cell_vertices_[i];
+        if (!is_active_[idx] || !is_reflex_[idx]) {
+          continue;
+        }
+
+        const auto& other = vertices_[idx];
+        if (other.id == triangle.v0->id || other.id == triangle.v1->id ||
+            other.id == triangle.v2->id) {
+          continue;
+        }
+
+        if (triangle.isInside(other.pos)) {
+          return false;
+        }
+      }
     }
   }
 
   return true;
 }
 
-TriangleIter Polygon::minAngleEar(const std::vector<bool>& ears) const {
-  auto iter = begin();
-  auto max_ear = end();
-  double max_cosine = 0.0;
-  VLOG(10) << "Finding minimum ear:";
-  while (iter != end()) {
-    const auto is_ear = ears[iter->v1->id];
-    const auto curr_cosine = iter->interiorAngle(is_ccw_);
-    VLOG(10) << std::boolalpha << *iter << ": ear=" << is_ear
-             << ", angle=" << curr_cosine;
-    if (!is_ear) {
-      ++iter;
-      continue;
-    }
-
-    if (curr_cosine > max_cosine) {
-      max_ear = iter;
-      max_cosine = curr_cosine;
-    }
-
-    ++iter;
-  }
-
-  VLOG(10) << "Best ear: " << *max_ear << " (angle: " << max_cosine << ")";
-  return max_ear;
-}
-
-TriangleIter Polygon::getFirstEar(const std::vector<bool>& ears) const {
-  auto iter = begin();
-  while (iter != end()) {
-    if (ears[iter->v1->id]) {
-      break;
-    }
-
-    ++iter;
-  }
-
-  return iter;
-}
-
 std::vector<std::array<size_t, 3>> Polygon::triangulate(bool use_first_ear) {
   if (vertices_.size() <= 2) {
     return {};
@@ -339,32 +383,69 @@ std::vector<std::array<size_t, 3>> Polygon::triangulate(bool use_first_ear) {
     return {{0, 1, 2}};
   }
 
+  // ears are either picked by largest cosine (smallest interior angle) or by polygon
+  // order, with ties going to the earliest vertex in polygon order. Candidates are
+  // kept in a heap and discarded lazily once their vertex is removed or changes.
+  const auto worse = [use_first_ear](const EarCandidate& lhs, const EarCandidate& rhs) {
+    if (!use_first_ear && lhs.cosine != rhs.cosine) {
+      return lhs.cosine < rhs.cosine;
+    }
+
+    return lhs.index > rhs.index;
+  };
+
   std::vector<bool> ears(vertices_.size(), false);
-  for (const auto& triangle : *this) {
-    if (isEar(triangle)) {
-      ears[triangle.v1->id] = true;
+  std::vector<double> cosines(vertices_.size(), 0.0);
+  std::vector<EarCandidate> candidates;
+  const auto update_ear = [&](const TriangleIter& iter) {
+    const auto idx = iter.index_;
+    ears[idx] = isEar(*iter);
+    cosines[idx] = iter->interiorAngle(is_ccw_);
+    // matches the old linear scan, which never picked ears without a positive cosine
+    if (ears[idx] && (use_first_ear || cosines[idx] > 0.0)) {
+      candidates.push_back({cosines[idx], idx});
+      std::push_heap(candidates.begin(), candidates.end(), worse);
     }
+  };
+
+  const auto next_ear = [&]() {
+    while (!candidates.empty()) {
+      std::pop_heap(candidates.begin(), candidates.end(), worse);
+      const auto candidate = candidates.back();
+      candidates.pop_back();
+      if (ears[candidate.index] && cosines[candidate.index] == candidate.cosine) {
+        return TriangleIter(this, candidate.index);
+      }
+    }
+
+    return end();
+  };
+
+  for (auto iter = begin(); iter != end(); ++iter) {
+    update_ear(iter);
   }
 
-  auto next_ear = use_first_ear ? getFirstEar(ears) : minAngleEar(ears);
   std::vector<std::array<size_t, 3>> faces;
+  faces.reserve(size());
   while (size() >= 3) {
-    if (next_ear == end()) {
+    const auto ear = next_ear();
+    if (ear == end()) {
       return faces;
     }
 
-    faces.push_back(next_ear->face());
-    ears[next_ear->v1->id] = false;
-    const auto next = erase(next_ear);
+    faces.push_back(ear->face());
+    ears[ear.index_] = false;
+    const auto next = erase(ear);
     if (size() == 3) {
       faces.push_back(begin()->face());
       break;
     }
 
     const auto prev = next.prev();
-    ears[prev->v1->id] = isEar(*prev);
-    ears[next->v1->id] = isEar(*next);
-    next_ear = use_first_ear ? getFirstEar(ears) : minAngleEar(ears);
+    updateReflex(prev.index_);
+    updateReflex(next.index_);
+    update_ear(prev);
+    update_ear(next);
   }
 
   return faces;
@@ -0,0 +1,125 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/occupancy_blocks.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+
+#include "hydra_ros/utils/grid_utilities.h"
+
+namespace hydra {
+
+bool OccupancyBlockMap::update(const hydra_msgs::OccupancyBlocks& msg) {
+  if (!msg.full_update && (!synchronized_ || msg.sequence != sequence_ + 1)) {
+    if (synchronized_) {
+      LOG(WARNING) << "Missed occupancy blocks between " << sequence_ << " and "
+                   << msg.sequence << ", waiting for full update";
+    }
+
+    // the blocks we have may be stale in ways later deltas can't fix
+    blocks_.clear();
+    synchronized_ = false;
+    return false;
+  }
+
+  synchronized_ = true;
+  sequence_ = msg.sequence;
+  if (msg.full_update || msg.voxel_size != voxel_size_ ||
+      msg.voxels_per_side != voxels_per_side_) {
+    blocks_.clear();
+    voxel_size_ = msg.voxel_size;
+    voxels_per_side_ = msg.voxels_per_side;
+  }
+
+  const auto block_bytes = packedBlockSize(voxels_per_side_);
+  for (const auto& block : msg.blocks) {
+    if (block.states.size() != block_bytes) {
+      LOG(WARNING) << "Dropping block [" << block.x << ", " << block.y << ", "
+                   << block.z << "] with " << block.states.size() << " bytes (expected "
+                   << block_bytes << ")";
+      continue;
+    }
+
+    blocks_[Eigen::Vector3i(block.x, block.y, block.z)] = block.states;
+  }
+
+  for (size_t i = 0; i + 2 < msg.removed.size(); i += 3) {
+    const Eigen::Vector3i index(msg.removed[i], msg.removed[i + 1], msg.removed[i + 2]);
+    blocks_.erase(index);
+  }
+
+  return true;
+}
+
+VoxelOccupancy OccupancyBlockMap::getOccupancy(const Eigen::Vector3f& point) const {
+  if (blocks_.empty()) {
+    return VoxelOccupancy::UNKNOWN;
+  }
+
+  const Eigen::Vector3i global_index =
+      (point / voxel_size_).array().floor().cast<int>();
+  const int vps = voxels_per_side_;
+  const Eigen::Vector3i block_index(floorDiv(global_index.x(), vps),
+                                     floorDiv(global_index.y(), vps),
+                                     floorDiv(global_index.z(), vps));
+  const auto iter = blocks_.find(block_index);
+  if (iter == blocks_.end()) {
+    return VoxelOccupancy::UNKNOWN;
+  }
+
+  const Eigen::Vector3i voxel = global_index - block_index * vps;
+  return unpackOccupancy(iter->second,
+                         packedVoxelIndex(vps, voxel.x(), voxel.y(), voxel.z()));
+}
+
+void OccupancyBlockMap::prune(const Eigen::Vector3f& center, float radius) {
+  const float block_size = voxel_size_ * voxels_per_side_;
+  for (auto iter = blocks_.begin(); iter != blocks_.end();) {
+    const Eigen::Vector3f origin = iter->first.cast<float>() * block_size;
+    if ((origin - center).norm() > radius) {
+      iter = blocks_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void OccupancyBlockMap::clear() {
+  blocks_.clear();
+  synchronized_ = false;
+}
+
+}  // namespace hydra
@@ -0,0 +1,231 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/occupancy_blocks_publisher.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/ros.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <hydra/common/global_info.h>
+
+#include "hydra_ros/utils/occupancy_blocks.h"
+
+namespace hydra {
+
+using Config = OccupancyBlocksPublisher::Config;
+
+VoxelOccupancy classifyVoxel(const Config& config, const TsdfVoxel& voxel) {
+  if (voxel.weight < config.min_observation_weight) {
+    return VoxelOccupancy::UNKNOWN;
+  }
+
+  return voxel.distance < config.min_distance ? VoxelOccupancy::OCCUPIED
+                                              : VoxelOccupancy::FREE;
+}
+
+VoxelOccupancy classifyVoxel(const Config& config, const places::GvdVoxel& voxel) {
+  if (!voxel.observed) {
+    return VoxelOccupancy::UNKNOWN;
+  }
+
+  return voxel.distance < config.min_distance ? VoxelOccupancy::OCCUPIED
+                                              : VoxelOccupancy::FREE;
+}
+
+template <typename BlockT>
+std::vector<uint8_t> packBlock(const Config& config, const BlockT& block) {
+  const size_t vps = block.voxels_per_side;
+  std::vector<uint8_t> states(packedBlockSize(vps), 0);
+  for (size_t z = 0; z < vps; ++z) {
+    for (size_t y = 0; y < vps; ++y) {
+      for (size_t x = 0; x < vps; ++x) {
+        const auto& voxel = block.getVoxel(VoxelIndex(x, y, z));
+        packOccupancy(
+            packedVoxelIndex(vps, x, y, z), classifyVoxel(config, voxel), states);
+      }
+    }
+  }
+
+  return states;
+}
+
+void declare_config(OccupancyBlocksPublisher::Config& config) {
+  using namespace config;
+  name("OccupancyBlocksPublisher::Config");
+  field(config.min_observation_weight, "min_observation_weight");
+  field(config.min_distance, "min_distance", "m");
+  field(config.full_update_period_s, "full_update_period_s", "s");
+  check(config.full_update_period_s, GE, 0.0, "full_update_period_s");
+}
+
+OccupancyBlocksPublisher::OccupancyBlocksPublisher(const Config& config,
+                                                   const ros::NodeHandle& nh)
+    : config(config::checkValid(config)),
+      nh_(nh),
+      send_full_(true),
+      last_full_ns_(0),
+      sequence_(0) {
+  // new subscribers need every block before deltas make sense
+  pub_ = nh_.advertise<hydra_msgs::OccupancyBlocks>(
+      "occupancy_blocks", 10, [this](const ros::SingleSubscriberPublisher&) {
+        send_full_ = true;
+      });
+  full_update_service_ = nh_.advertiseService(
+      "request_full_update", &OccupancyBlocksPublisher::handleFullUpdate, this);
+}
+
+bool OccupancyBlocksPublisher::handleFullUpdate(std_srvs::Empty::Request&,
+                                                std_srvs::Empty::Response&) {
+  send_full_ = true;
+  return true;
+}
+
+void OccupancyBlocksPublisher::publishTsdf(uint64_t timestamp_ns,
+                                           const TsdfLayer& tsdf) const {
+  publishImpl(timestamp_ns, tsdf);
+}
+
+void OccupancyBlocksPublisher::publishGvd(uint64_t timestamp_ns,
+                                          const places::GvdLayer& gvd) const {
+  publishImpl(timestamp_ns, gvd);
+}
+
+template <typename BlockT>
+void OccupancyBlocksPublisher::publishImpl(
+    uint64_t timestamp_ns, const spatial_hash::VoxelLayer<BlockT>& layer) const {
+  if (pub_.getNumSubscribers() == 0) {
+    // deltas are relative to what we've sent, so start from scratch next time
+    sent_.clear();
+    send_full_ = true;
+    return;
+  }
+
+  hydra_msgs::OccupancyBlocks msg;
+  msg.header.frame_id = GlobalInfo::instance().getFrames().map;
+  msg.header.stamp.fromNSec(timestamp_ns);
+  msg.voxel_size = layer.voxel_size;
+  msg.voxels_per_side = layer.voxels_per_side;
+  const auto elapsed_s = (timestamp_ns - last_full_ns_) * 1.0e-9;
+  const bool period_elapsed =
+      config.full_update_period_s > 0.0 && elapsed_s >= config.full_update_period_s;
+  msg.full_update = send_full_.exchange(false) || period_elapsed;
+  if (msg.full_update) {
+    sent_.clear();
+    last_full_ns_ = timestamp_ns;
+  }
+
+  spatial_hash::BlockIndexSet seen;
+  for (const auto& block : layer) {
+    seen.insert(block.index);
+    auto iter = sent_.find(block.index);
+    if (iter != sent_.end() && !block.updated) {
+      continue;
+    }
+
+    auto states = packBlock(config, block);
+    if (iter != sent_.end()) {
+      if (iter->second == states) {
+        continue;
+      }
+
+      iter->second = states;
+    } else {
+      sent_.emplace(block.index, states);
+    }
+
+    auto& block_msg = msg.blocks.emplace_back();
+    block_msg.x = block.index.x();
+    block_msg.y = block.index.y();
+    block_msg.z = block.index.z();
+    block_msg.states = std::move(states);
+  }
+
+  for (auto iter = sent_.begin(); iter != sent_.end();) {
+    if (seen.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    msg.removed.push_back(iter->first.x());
+    msg.removed.push_back(iter->first.y());
+    msg.removed.push_back(iter->first.z());
+    iter = sent_.erase(iter);
+  }
+
+  if (!msg.full_update && msg.blocks.empty() && msg.removed.empty()) {
+    return;
+  }
+
+  msg.sequence = ++sequence_;
+  pub_.publish(msg);
+}
+
+void declare_config(TsdfOccupancyBlocksPublisher::Config& config) {
+  using namespace config;
+  name("TsdfOccupancyBlocksPublisher::Config");
+  field(config.ns, "ns");
+  field(config.extraction, "extraction");
+}
+
+TsdfOccupancyBlocksPublisher::TsdfOccupancyBlocksPublisher(const Config& config)
+    : config(config),
+      pub_(OccupancyBlocksPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+
+void TsdfOccupancyBlocksPublisher::call(uint64_t timestamp_ns,
+                                        const Eigen::Isometry3d&,
+                                        const TsdfLayer& tsdf,
+                                        const ReconstructionOutput&) const {
+  pub_.publishTsdf(timestamp_ns, tsdf);
+}
+
+void declare_config(GvdOccupancyBlocksPublisher::Config& config) {
+  using namespace config;
+  name("GvdOccupancyBlocksPublisher::Config");
+  field(config.ns, "ns");
+  field(config.extraction, "extraction");
+}
+
+GvdOccupancyBlocksPublisher::GvdOccupancyBlocksPublisher(const Config& config)
+    : config(config),
+      pub_(OccupancyBlocksPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+
+void GvdOccupancyBlocksPublisher::call(uint64_t timestamp_ns,
+                                       const Eigen::Isometry3f&,
+                                       const places::GvdLayer& gvd,
+                                       const places::GraphExtractorInterface*) const {
+  pub_.publishGvd(timestamp_ns, gvd);
+}
+
+}  // namespace hydra
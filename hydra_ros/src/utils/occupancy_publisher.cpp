@@ -40,8 +40,14 @@
 #include <config_utilities/types/eigen_matrix.h>
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
+#include <map_msgs/OccupancyGridUpdate.h>
 #include <nav_msgs/OccupancyGrid.h>
 
+#include <thread>
+
+#include "hydra_ros/utils/grid_utilities.h"
+#include "hydra_ros/utils/occupancy_tiles.h"
+
 namespace hydra {
 
 template <typename T>
@@ -74,131 +80,176 @@ bool isObserved(const places::GvdVoxel& voxel, float) {
   return voxel.observed;
 }
 
-struct Bounds {
+template <>
+bool isObserved(const OccupancyVoxel& voxel, float) {
+  return voxel.observed;
+}
+
+template <typename T>
+bool isOccupied(const T& voxel, float min_distance) {
+  return getDistance(voxel) < min_distance;
+}
+
+template <>
+bool isOccupied(const OccupancyVoxel& voxel, float) {
+  return voxel.occupied;
+}
+
+// avoid paying for thread startup when only a few columns changed
+constexpr size_t kMinColumnsPerThread = 64;
+
+inline BlockIndex columnIndex(const BlockIndex& index) {
+  return BlockIndex(index.x(), index.y(), 0);
+}
+
+std::vector<BlockIndex> getFootprintColumns(const OccupancyPublisher::Config& config,
+                                            const Eigen::Isometry3d& world_T_sensor,
+                                            float block_size) {
+  if (!config.add_robot_footprint) {
+    return {};
+  }
+
+  // project all corners of the footprint into the world frame to get a 2D extent
   Eigen::Vector2f x_min = Eigen::Vector2f::Constant(std::numeric_limits<float>::max());
   Eigen::Vector2f x_max =
       Eigen::Vector2f::Constant(std::numeric_limits<float>::lowest());
-  Eigen::Vector2f dims = Eigen::Vector2f::Zero();
-};
-
-template <typename BlockT>
-Bounds getLayerBounds(const spatial_hash::VoxelLayer<BlockT>& layer) {
-  Bounds bounds;
+  const Eigen::Isometry3f world_T_sensor_f = world_T_sensor.cast<float>();
+  for (size_t i = 0; i < 8; ++i) {
+    const Eigen::Vector3f corner((i & 1) ? config.footprint_max.x()
+                                         : config.footprint_min.x(),
+                                 (i & 2) ? config.footprint_max.y()
+                                         : config.footprint_min.y(),
+                                 (i & 4) ? config.footprint_max.z()
+                                         : config.footprint_min.z());
+    const Eigen::Vector3f world_corner = world_T_sensor_f * corner;
+    x_min = x_min.array().min(world_corner.head<2>().array());
+    x_max = x_max.array().max(world_corner.head<2>().array());
+  }
 
-  for (const auto& block : layer) {
-    const auto lower = block.origin();
-    const auto upper = lower + Point::Constant(block.block_size);
-    bounds.x_min = bounds.x_min.array().min(lower.template head<2>().array());
-    bounds.x_max = bounds.x_max.array().max(upper.template head<2>().array());
+  const Eigen::Vector2i min_index = (x_min / block_size).array().floor().cast<int>();
+  const Eigen::Vector2i max_index = (x_max / block_size).array().floor().cast<int>();
+  std::vector<BlockIndex> columns;
+  for (int x = min_index.x(); x <= max_index.x(); ++x) {
+    for (int y = min_index.y(); y <= max_index.y(); ++y) {
+      columns.emplace_back(x, y, 0);
+    }
   }
 
-  bounds.dims = (bounds.x_max - bounds.x_min) / layer.voxel_size;
-  return bounds;
+  return columns;
 }
 
 template <typename BlockT>
-void initGrid(const spatial_hash::VoxelLayer<BlockT>& layer,
-              const Bounds& bounds,
-              double height,
-              nav_msgs::OccupancyGrid& msg) {
-  msg.info.resolution = layer.voxel_size;
-  msg.info.width = std::ceil(bounds.dims.x());
-  msg.info.height = std::ceil(bounds.dims.y());
-  msg.info.origin.position.x = bounds.x_min.x();
-  msg.info.origin.position.y = bounds.x_min.y();
-  msg.info.origin.position.z = height;
-  msg.info.origin.orientation.w = 1.0;
-  msg.data.resize(msg.info.width * msg.info.height, -1);
-}
-
-template <typename BlockT>
-void fillOccupancySlice(const OccupancyPublisher::Config& config,
-                        const spatial_hash::VoxelLayer<BlockT>& layer,
-                        const Eigen::Isometry3d& world_T_sensor,
-                        const Bounds& bounds,
-                        double height,
-                        nav_msgs::OccupancyGrid& msg) {
-  const Point slice_pos(0, 0, height);
-  const auto slice_key = layer.getVoxelKey(slice_pos);
-  auto bbox = config.add_robot_footprint
-                  ? BoundingBox(config.footprint_min, config.footprint_max)
-                  : BoundingBox();
-  const Eigen::Isometry3f sensor_T_world = world_T_sensor.inverse().cast<float>();
+void fillOccupancyColumn(const OccupancyPublisher::Config& config,
+                         const spatial_hash::VoxelLayer<BlockT>& layer,
+                         const Eigen::Isometry3f& sensor_T_world,
+                         const BlockIndex& column,
+                         int64_t slice_index,
+                         bool check_footprint,
+                         const Eigen::Vector2i& grid_origin,
+                         nav_msgs::OccupancyGrid& msg) {
+  const int vps = layer.voxels_per_side;
+  const Eigen::Vector2i column_origin = column.head<2>() * vps - grid_origin;
+  const BoundingBox bbox(config.footprint_min, config.footprint_max);
+
+  // look up every slice once so each cell can be resolved in a single pass
+  std::vector<std::pair<const BlockT*, int>> slices;
+  slices.reserve(config.num_slices);
+  for (size_t i = 0; i < config.num_slices; ++i) {
+    const int64_t global_z = slice_index + static_cast<int64_t>(i);
+    const int block_z = floorDiv(global_z, vps);
+    const auto block_ptr = layer.getBlockPtr(BlockIndex(column.x(), column.y(), block_z));
+    if (block_ptr) {
+      slices.emplace_back(block_ptr.get(), global_z - block_z * vps);
+    }
+  }
 
-  for (const auto block_ptr :
-       layer.blocksWithCondition([&slice_key](const BlockT& block) {
-         return block.index.z() == slice_key.first.z();
-       })) {
-    for (size_t x = 0; x < block_ptr->voxels_per_side; ++x) {
-      for (size_t y = 0; y < block_ptr->voxels_per_side; ++y) {
-        const VoxelIndex voxel_index(x, y, slice_key.second.z());
-        const auto& voxel = block_ptr->getVoxel(voxel_index);
-        const Eigen::Vector3f pos = block_ptr->getVoxelPosition(voxel_index);
-        const auto rel_pos = pos.head<2>() - bounds.x_min;
-        // pos is center point, so we want floor
-        const auto r = std::floor(rel_pos.y() / layer.voxel_size);
-        const auto c = std::floor(rel_pos.x() / layer.voxel_size);
-        const size_t index = r * msg.info.width + c;
-
-        if (config.add_robot_footprint &&
-            bbox.contains((sensor_T_world * pos).eval())) {
-          msg.data[index] = 0;
-          continue;
+  for (int y = 0; y < vps; ++y) {
+    const size_t row = (column_origin.y() + y) * msg.info.width + column_origin.x();
+    for (int x = 0; x < vps; ++x) {
+      // later slices take precedence, except that free never overwrites occupied
+      int8_t value = -1;
+      for (const auto& [block, voxel_z] : slices) {
+        const VoxelIndex voxel_index(x, y, voxel_z);
+        if (check_footprint) {
+          const Eigen::Vector3f pos = block->getVoxelPosition(voxel_index);
+          if (bbox.contains((sensor_T_world * pos).eval())) {
+            value = 0;
+            continue;
+          }
         }
 
+        const auto& voxel = block->getVoxel(voxel_index);
         if (!isObserved(voxel, config.min_observation_weight)) {
-          msg.data[index] = -2;
+          value = -2;
           continue;
         }
 
-        const auto occupied = getDistance(voxel) < config.min_distance;
-        if (occupied) {
-          msg.data[index] = 100;
+        if (isOccupied(voxel, config.min_distance)) {
+          value = 100;
           continue;
         }
 
-        if (msg.data[index] == -1) {
+        if (value == -1) {
           // we only can mark cells as free if they haven't been touched
-          msg.data[index] = 0;
+          value = 0;
         }
       }
+
+      // cells marked unobserved are reported as unknown
+      msg.data[row + x] = value == -2 ? -1 : value;
     }
   }
 }
 
-template <typename BlockT>
-void fillOccupancy(const OccupancyPublisher::Config& config,
-                   const spatial_hash::VoxelLayer<BlockT>& layer,
-                   const Eigen::Isometry3d& world_T_sensor,
-                   nav_msgs::OccupancyGrid& msg) {
-  const auto bounds = getLayerBounds(layer);
-  auto height = config.slice_height;
-  if (config.use_relative_height) {
-    height += world_T_sensor.translation().z();
-  }
-
-  initGrid(layer, bounds, height, msg);
-  for (size_t i = 0; i < config.num_slices; ++i) {
-    const auto curr_height = height + i * layer.voxel_size;
-    fillOccupancySlice(config, layer, world_T_sensor, bounds, curr_height, msg);
-  }
+template void fillOccupancyColumn(const OccupancyPublisher::Config&,
+                                  const TsdfLayer&,
+                                  const Eigen::Isometry3f&,
+                                  const BlockIndex&,
+                                  int64_t,
+                                  bool,
+                                  const Eigen::Vector2i&,
+                                  nav_msgs::OccupancyGrid&);
+
+template void fillOccupancyColumn(const OccupancyPublisher::Config&,
+                                  const places::GvdLayer&,
+                                  const Eigen::Isometry3f&,
+                                  const BlockIndex&,
+                                  int64_t,
+                                  bool,
+                                  const Eigen::Vector2i&,
+                                  nav_msgs::OccupancyGrid&);
+
+template void fillOccupancyColumn(const OccupancyPublisher::Config&,
+                                  const OccupancyLayer&,
+                                  const Eigen::Isometry3f&,
+                                  const BlockIndex&,
+                                  int64_t,
+                                  bool,
+                                  const Eigen::Vector2i&,
+                                  nav_msgs::OccupancyGrid&);
 
-  // clean up all cells that were marked unobserved
-  for (size_t i = 0; i < msg.data.size(); ++i) {
-    if (msg.data[i] == -2) {
-      msg.data[i] = -1;
+template <typename BlockT>
+void collateImpl(const OccupancyPublisher::Config& config,
+                 const spatial_hash::VoxelLayer<BlockT>& layer_in,
+                 OccupancyLayer& layer_out,
+                 std::vector<BlockIndex>& collated) {
+  // only blocks copied during this call should show up as changed
+  for (const auto& index : collated) {
+    const auto block = layer_out.getBlockPtr(index);
+    if (block) {
+      block->updated = false;
     }
   }
-}
 
-template <typename BlockT>
-void collate(const spatial_hash::VoxelLayer<BlockT>& layer_in,
-             spatial_hash::VoxelLayer<BlockT>& layer_out,
-             double min_observation_weight) {
+  collated.clear();
   for (const auto& block : layer_in) {
+    if (!block.updated && layer_out.hasBlock(block.index)) {
+      continue;
+    }
+
     bool unobserved = true;
     for (size_t i = 0; i < block.numVoxels(); ++i) {
-      if (isObserved(block.getVoxel(i), min_observation_weight)) {
+      if (isObserved(block.getVoxel(i), config.min_observation_weight)) {
         unobserved = false;
         break;
       }
@@ -209,16 +260,33 @@ void collate(const spatial_hash::VoxelLayer<BlockT>& layer_in,
     }
 
     auto new_block = layer_out.allocateBlockPtr(block.index);
-    new_block->updated = block.updated;
+    new_block->updated = true;
+    collated.push_back(block.index);
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
-      if (isObserved(voxel, min_observation_weight)) {
-        new_block->getVoxel(i) = voxel;
+      if (isObserved(voxel, config.min_observation_weight)) {
+        auto& new_voxel = new_block->getVoxel(i);
+        new_voxel.observed = true;
+        new_voxel.occupied = isOccupied(voxel, config.min_distance);
       }
     }
   }
 }
 
+void collate(const OccupancyPublisher::Config& config,
+             const TsdfLayer& layer_in,
+             OccupancyLayer& layer_out,
+             std::vector<BlockIndex>& collated) {
+  collateImpl(config, layer_in, layer_out, collated);
+}
+
+void collate(const OccupancyPublisher::Config& config,
+             const places::GvdLayer& layer_in,
+             OccupancyLayer& layer_out,
+             std::vector<BlockIndex>& collated) {
+  collateImpl(config, layer_in, layer_out, collated);
+}
+
 void declare_config(OccupancyPublisher::Config& config) {
   using namespace config;
   name("OccupancyPublisher::Config");
@@ -230,47 +298,341 @@ void declare_config(OccupancyPublisher::Config& config) {
   field(config.add_robot_footprint, "add_robot_footprint");
   field(config.footprint_min, "footprint_min");
   field(config.footprint_max, "footprint_max");
+  field(config.full_grid_period_s, "full_grid_period_s", "s");
+  field(config.num_threads, "num_threads");
+  check(config.full_grid_period_s, GE, 0.0, "full_grid_period_s");
+  field(config.tile_size, "tile_size");
+  field(config.num_tile_levels, "num_tile_levels");
+  field(config.local_window_m, "local_window_m", "m");
+  check(config.num_threads, GT, static_cast<size_t>(0), "num_threads");
+  check(config.local_window_m, GE, 0.0, "local_window_m");
+}
+
+IncrementalOccupancyGrid::IncrementalOccupancyGrid(const Config& config)
+    : config_(config) {
+  reset();
+}
+
+void IncrementalOccupancyGrid::reset() {
+  msg_.info.width = 0;
+  msg_.info.height = 0;
+  msg_.data.clear();
+  origin_.setZero();
+  voxel_size_ = 0.0f;
+  voxels_per_side_ = 0;
+  slice_index_ = 0;
+  columns_.clear();
+  footprint_columns_.clear();
+  regions_.clear();
+  requires_full_ = true;
+}
+
+size_t IncrementalOccupancyGrid::update(const Eigen::Isometry3d& world_T_sensor,
+                                        const TsdfLayer& layer) {
+  return updateImpl(world_T_sensor, layer);
+}
+
+size_t IncrementalOccupancyGrid::update(const Eigen::Isometry3d& world_T_sensor,
+                                        const places::GvdLayer& layer) {
+  return updateImpl(world_T_sensor, layer);
+}
+
+size_t IncrementalOccupancyGrid::update(const Eigen::Isometry3d& world_T_sensor,
+                                        const OccupancyLayer& layer) {
+  return updateImpl(world_T_sensor, layer);
+}
+
+template <typename BlockT>
+size_t IncrementalOccupancyGrid::updateImpl(
+    const Eigen::Isometry3d& world_T_sensor,
+    const spatial_hash::VoxelLayer<BlockT>& layer) {
+  if (layer.voxel_size != voxel_size_ ||
+      static_cast<int>(layer.voxels_per_side) != voxels_per_side_) {
+    reset();
+    voxel_size_ = layer.voxel_size;
+    voxels_per_side_ = layer.voxels_per_side;
+  }
+
+  auto height = config_.slice_height;
+  if (config_.use_relative_height) {
+    height += world_T_sensor.translation().z();
+  }
+
+  const auto slice_key = layer.getVoxelKey(Point(0, 0, height));
+  const int64_t slice_index =
+      static_cast<int64_t>(slice_key.first.z()) * voxels_per_side_ +
+      slice_key.second.z();
+  if (slice_index != slice_index_) {
+    // every column depends on the slice height, so start over (but keep the extent)
+    std::fill(msg_.data.begin(), msg_.data.end(), -1);
+    columns_.clear();
+    slice_index_ = slice_index;
+    requires_full_ = true;
+  }
+
+  const auto min_block_z = floorDiv(slice_index, voxels_per_side_);
+  const int64_t num_slices = config_.num_slices;
+  const auto max_block_z = floorDiv(slice_index + num_slices - 1, voxels_per_side_);
+  const auto changes = columns_.update(layer, min_block_z, max_block_z);
+  spatial_hash::BlockIndexSet dirty(changes.updated.begin(), changes.updated.end());
+
+  // the footprint moves with the robot, so both old and new cells need to be redone
+  auto footprint_columns =
+      getFootprintColumns(config_, world_T_sensor, layer.blockSize());
+  for (const auto* columns : {&footprint_columns_, &footprint_columns}) {
+    for (const auto& column : *columns) {
+      if (columns_.contains(column)) {
+        dirty.insert(column);
+      }
+    }
+  }
+
+  // removed columns revert to unknown
+  for (const auto& column : changes.removed) {
+    clearColumn(column);
+  }
+
+  // columns cover disjoint cells, so they can be filled in any order
+  const std::vector<BlockIndex> to_fill(dirty.begin(), dirty.end());
+  if (!to_fill.empty()) {
+    reserve(getColumnBounds(to_fill, voxels_per_side_));
+  }
+
+  const spatial_hash::BlockIndexSet footprint(footprint_columns.begin(),
+                                              footprint_columns.end());
+  const Eigen::Isometry3f sensor_T_world = world_T_sensor.inverse().cast<float>();
+  const auto fill = [&](size_t start, size_t stride) {
+    for (size_t i = start; i < to_fill.size(); i += stride) {
+      const auto& column = to_fill[i];
+      fillOccupancyColumn(config_,
+                          layer,
+                          sensor_T_world,
+                          column,
+                          slice_index_,
+                          footprint.count(column) > 0,
+                          origin_,
+                          msg_);
+    }
+  };
+
+  const size_t num_threads =
+      std::min(config_.num_threads, to_fill.size() / kMinColumnsPerThread);
+  if (num_threads <= 1) {
+    fill(0, 1);
+  } else {
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(fill, i, num_threads);
+    }
+
+    fill(0, num_threads);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  std::vector<BlockIndex> changed = changes.removed;
+  changed.insert(changed.end(), to_fill.begin(), to_fill.end());
+  regions_ = getColumnRegions(changed, voxels_per_side_, origin_);
+  msg_.info.origin.position.z = height;
+  footprint_columns_ = std::move(footprint_columns);
+  return to_fill.size();
+}
+
+void IncrementalOccupancyGrid::reserve(const GridRegion& cells) {
+  const GridExtent extent{origin_, Eigen::Vector2i(msg_.info.width, msg_.info.height)};
+  if (extent.contains(cells.min, cells.max)) {
+    return;
+  }
+
+  requires_full_ = true;
+  const auto new_extent = growExtent(extent, cells.min, cells.max, voxels_per_side_);
+  resizeGrid<int8_t>(extent, new_extent, -1, msg_.data);
+
+  origin_ = new_extent.min;
+  msg_.info.resolution = voxel_size_;
+  msg_.info.width = new_extent.dims.x();
+  msg_.info.height = new_extent.dims.y();
+  msg_.info.origin.position.x = origin_.x() * voxel_size_;
+  msg_.info.origin.position.y = origin_.y() * voxel_size_;
+  msg_.info.origin.orientation.w = 1.0;
+}
+
+void IncrementalOccupancyGrid::clearColumn(const BlockIndex& column) {
+  const Eigen::Vector2i lower = column.head<2>() * voxels_per_side_ - origin_;
+  if (msg_.data.empty() || (lower.array() < 0).any() ||
+      lower.x() + voxels_per_side_ > static_cast<int>(msg_.info.width) ||
+      lower.y() + voxels_per_side_ > static_cast<int>(msg_.info.height)) {
+    return;
+  }
+
+  for (int y = 0; y < voxels_per_side_; ++y) {
+    const auto row = msg_.data.begin() + (lower.y() + y) * msg_.info.width + lower.x();
+    std::fill(row, row + voxels_per_side_, -1);
+  }
 }
 
 OccupancyPublisher::OccupancyPublisher(const Config& config, const ros::NodeHandle& nh)
     : config(config::checkValid(config)),
       nh_(nh),
-      pub_(nh_.advertise<nav_msgs::OccupancyGrid>("occupancy", 1, true)) {}
+      grid_(std::make_unique<IncrementalOccupancyGrid>(this->config)),
+      send_full_grid_(true),
+      last_full_grid_ns_(0),
+      send_all_tiles_(true) {
+  // late subscribers only have the last (latched) full grid, so send a new one
+  pub_ = nh_.advertise<nav_msgs::OccupancyGrid>(
+      "occupancy",
+      1,
+      [this](const ros::SingleSubscriberPublisher&) { send_full_grid_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      true);
+  update_pub_ = nh_.advertise<map_msgs::OccupancyGridUpdate>("occupancy_updates", 10);
+
+  if (this->config.local_window_m > 0.0) {
+    local_pub_ = nh_.advertise<nav_msgs::OccupancyGrid>("occupancy_local", 1, true);
+  }
+
+  if (this->config.tile_size == 0) {
+    return;
+  }
+
+  // tile subscribers need every tile once before changes are meaningful
+  const auto on_connect = [this](const ros::SingleSubscriberPublisher&) {
+    send_all_tiles_ = true;
+  };
+  for (size_t i = 0; i < this->config.num_tile_levels; ++i) {
+    tile_pubs_.push_back(nh_.advertise<nav_msgs::OccupancyGrid>(
+        "occupancy_tiles/level_" + std::to_string(i), 100, on_connect));
+  }
+}
 
 OccupancyPublisher::~OccupancyPublisher() {}
 
 void OccupancyPublisher::publishTsdf(uint64_t timestamp_ns,
                                      const Eigen::Isometry3d& world_T_sensor,
                                      const TsdfLayer& tsdf) const {
-  if (pub_.getNumSubscribers() == 0) {
+  if (!hasSubscribers()) {
+    // we can't track changes without updating, so rebuild when someone subscribes
+    grid_->reset();
     return;
   }
 
-  nav_msgs::OccupancyGrid msg;
-  msg.header.frame_id = GlobalInfo::instance().getFrames().map;
-  msg.header.stamp.fromNSec(timestamp_ns);
-
-  msg.info.map_load_time = msg.header.stamp;
-
-  fillOccupancy(config, tsdf, world_T_sensor, msg);
-  pub_.publish(msg);
+  grid_->update(world_T_sensor, tsdf);
+  publish(timestamp_ns, world_T_sensor);
 }
 
 void OccupancyPublisher::publishGvd(uint64_t timestamp_ns,
                                     const Eigen::Isometry3d& world_T_sensor,
                                     const places::GvdLayer& gvd) const {
-  if (pub_.getNumSubscribers() == 0) {
+  if (!hasSubscribers()) {
+    grid_->reset();
     return;
   }
 
-  nav_msgs::OccupancyGrid msg;
+  grid_->update(world_T_sensor, gvd);
+  publish(timestamp_ns, world_T_sensor);
+}
+
+void OccupancyPublisher::publishOccupancy(uint64_t timestamp_ns,
+                                          const Eigen::Isometry3d& world_T_sensor,
+                                          const OccupancyLayer& layer) const {
+  if (!hasSubscribers()) {
+    grid_->reset();
+    return;
+  }
+
+  grid_->update(world_T_sensor, layer);
+  publish(timestamp_ns, world_T_sensor);
+}
+
+bool OccupancyPublisher::hasSubscribers() const {
+  if (pub_.getNumSubscribers() > 0 || update_pub_.getNumSubscribers() > 0) {
+    return true;
+  }
+
+  if (local_pub_ && local_pub_.getNumSubscribers() > 0) {
+    return true;
+  }
+
+  return std::any_of(tile_pubs_.begin(), tile_pubs_.end(), [](const auto& pub) {
+    return pub.getNumSubscribers() > 0;
+  });
+}
+
+void OccupancyPublisher::publish(uint64_t timestamp_ns,
+                                 const Eigen::Isometry3d& world_T_sensor) const {
+  auto& msg = grid_->grid();
   msg.header.frame_id = GlobalInfo::instance().getFrames().map;
   msg.header.stamp.fromNSec(timestamp_ns);
 
-  msg.info.map_load_time = msg.header.stamp;
+  if (local_pub_ && local_pub_.getNumSubscribers() > 0 && !msg.data.empty()) {
+    nav_msgs::OccupancyGrid local_msg;
+    extractWindow(*grid_,
+                  world_T_sensor.translation().head<2>(),
+                  config.local_window_m,
+                  local_msg);
+    local_pub_.publish(local_msg);
+  }
+
+  publishTiles();
 
-  fillOccupancy(config, gvd, world_T_sensor, msg);
+  const auto elapsed_s = (timestamp_ns - last_full_grid_ns_) * 1.0e-9;
+  const bool period_elapsed =
+      config.full_grid_period_s > 0.0 && elapsed_s >= config.full_grid_period_s;
+  const bool send_full =
+      send_full_grid_.exchange(false) || grid_->requiresFullGrid() || period_elapsed;
+  if (!send_full) {
+    publishUpdates();
+    return;
+  }
+
+  msg.info.map_load_time = msg.header.stamp;
   pub_.publish(msg);
+  grid_->clearRequiresFullGrid();
+  last_full_grid_ns_ = timestamp_ns;
+}
+
+void OccupancyPublisher::publishTiles() const {
+  // a cleared or reallocated grid may have changed outside the changed regions
+  const bool send_all = send_all_tiles_.exchange(false) || grid_->requiresFullGrid();
+  for (size_t level = 0; level < tile_pubs_.size(); ++level) {
+    const auto& pub = tile_pubs_[level];
+    if (pub.getNumSubscribers() == 0) {
+      continue;
+    }
+
+    for (const auto& tile :
+         getChangedTiles(*grid_, config.tile_size, level, send_all)) {
+      nav_msgs::OccupancyGrid msg;
+      extractTile(*grid_, tile, config.tile_size, level, msg);
+      pub.publish(msg);
+    }
+  }
+}
+
+void OccupancyPublisher::publishUpdates() const {
+  if (update_pub_.getNumSubscribers() == 0) {
+    return;
+  }
+
+  const auto& grid = grid_->grid();
+  for (const auto& region : grid_->changedRegions()) {
+    const Eigen::Vector2i dims = region.max - region.min;
+    map_msgs::OccupancyGridUpdate msg;
+    msg.header = grid.header;
+    msg.x = region.min.x();
+    msg.y = region.min.y();
+    msg.width = dims.x();
+    msg.height = dims.y();
+    msg.data.reserve(dims.x() * dims.y());
+    for (int r = region.min.y(); r < region.max.y(); ++r) {
+      const auto row = grid.data.begin() + r * grid.info.width + region.min.x();
+      msg.data.insert(msg.data.end(), row, row + dims.x());
+    }
+
+    update_pub_.publish(msg);
+  }
 }
 
 TsdfOccupancyPublisher::TsdfOccupancyPublisher(const Config& config)
@@ -278,7 +640,8 @@ TsdfOccupancyPublisher::TsdfOccupancyPublisher(const Config& config)
       pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
 
 GvdOccupancyPublisher::GvdOccupancyPublisher(const Config& config)
-    : pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+    : config(config),
+      pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
 
 void TsdfOccupancyPublisher::call(uint64_t timestamp_ns,
                                   const Eigen::Isometry3d& world_T_sensor,
@@ -290,11 +653,11 @@ void TsdfOccupancyPublisher::call(uint64_t timestamp_ns,
   }
 
   if (!tsdf_) {
-    tsdf_.reset(new TsdfLayer(tsdf.voxel_size, tsdf.voxels_per_side));
+    tsdf_.reset(new OccupancyLayer(tsdf.voxel_size, tsdf.voxels_per_side));
   }
 
-  collate(tsdf, *tsdf_, config.extraction.min_observation_weight);
-  pub_.publishTsdf(timestamp_ns, world_T_sensor, *tsdf_);
+  collate(pub_.config, tsdf, *tsdf_, collated_);
+  pub_.publishOccupancy(timestamp_ns, world_T_sensor, *tsdf_);
 }
 
 void GvdOccupancyPublisher::call(uint64_t timestamp_ns,
@@ -307,11 +670,11 @@ void GvdOccupancyPublisher::call(uint64_t timestamp_ns,
   }
 
   if (!gvd_) {
-    gvd_.reset(new places::GvdLayer(gvd.voxel_size, gvd.voxels_per_side));
+    gvd_.reset(new OccupancyLayer(gvd.voxel_size, gvd.voxels_per_side));
   }
 
-  collate(gvd, *gvd_, config.extraction.min_observation_weight);
-  pub_.publishGvd(timestamp_ns, world_T_body.cast<double>(), *gvd_);
+  collate(pub_.config, gvd, *gvd_, collated_);
+  pub_.publishOccupancy(timestamp_ns, world_T_body.cast<double>(), *gvd_);
 }
 
 void declare_config(GvdOccupancyPublisher::Config& config) {
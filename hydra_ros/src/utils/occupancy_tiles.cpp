@@ -0,0 +1,142 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/occupancy_tiles.h"
+
+#include <algorithm>
+
+#include "hydra_ros/utils/grid_utilities.h"
+#include "hydra_ros/utils/occupancy_publisher.h"
+
+namespace hydra {
+
+inline Eigen::Vector2i tileFromCell(const Eigen::Vector2i& cell, int tile_cells) {
+  return Eigen::Vector2i(floorDiv(cell.x(), tile_cells),
+                         floorDiv(cell.y(), tile_cells));
+}
+
+std::vector<Eigen::Vector2i> getChangedTiles(const IncrementalOccupancyGrid& grid,
+                                             size_t tile_size,
+                                             size_t level,
+                                             bool all) {
+  const auto& msg = grid.grid();
+  if (msg.data.empty()) {
+    return {};
+  }
+
+  std::vector<GridRegion> regions;
+  if (all) {
+    regions.push_back({Eigen::Vector2i::Zero(),
+                       Eigen::Vector2i(msg.info.width, msg.info.height)});
+  } else {
+    regions = grid.changedRegions();
+  }
+
+  const int tile_cells = tile_size << level;
+  std::vector<Eigen::Vector2i> tiles;
+  for (const auto& region : regions) {
+    const auto min_tile = tileFromCell(grid.origin() + region.min, tile_cells);
+    const auto max_tile = tileFromCell(
+        grid.origin() + region.max - Eigen::Vector2i::Ones(), tile_cells);
+    for (int x = min_tile.x(); x <= max_tile.x(); ++x) {
+      for (int y = min_tile.y(); y <= max_tile.y(); ++y) {
+        tiles.emplace_back(x, y);
+      }
+    }
+  }
+
+  const auto less = [](const Eigen::Vector2i& lhs, const Eigen::Vector2i& rhs) {
+    return lhs.x() == rhs.x() ? lhs.y() < rhs.y() : lhs.x() < rhs.x();
+  };
+  std::sort(tiles.begin(), tiles.end(), less);
+  tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+  return tiles;
+}
+
+void extractRegion(const IncrementalOccupancyGrid& grid,
+                   const Eigen::Vector2i& lower,
+                   const Eigen::Vector2i& dims,
+                   int scale,
+                   nav_msgs::OccupancyGrid& msg) {
+  const auto& full = grid.grid();
+  msg.header = full.header;
+  msg.info.map_load_time = full.header.stamp;
+  msg.info.resolution = full.info.resolution * scale;
+  msg.info.width = dims.x();
+  msg.info.height = dims.y();
+  msg.info.origin.position.x = lower.x() * full.info.resolution;
+  msg.info.origin.position.y = lower.y() * full.info.resolution;
+  msg.info.origin.position.z = full.info.origin.position.z;
+  msg.info.origin.orientation.w = 1.0;
+  msg.data.assign(dims.x() * dims.y(), -1);
+
+  // only visit the cells that overlap the grid
+  const Eigen::Vector2i grid_dims(full.info.width, full.info.height);
+  const Eigen::Vector2i start = (lower - grid.origin()).cwiseMax(0);
+  const Eigen::Vector2i end =
+      (lower - grid.origin() + dims * scale).cwiseMin(grid_dims);
+  const Eigen::Vector2i offset = grid.origin() - lower;
+  for (int r = start.y(); r < end.y(); ++r) {
+    const auto out_row = ((r + offset.y()) / scale) * dims.x();
+    const auto in_row = r * full.info.width;
+    for (int c = start.x(); c < end.x(); ++c) {
+      // -1 (unknown) < 0 (free) < 100 (occupied), so max is conservative
+      auto& value = msg.data[out_row + (c + offset.x()) / scale];
+      value = std::max(value, full.data[in_row + c]);
+    }
+  }
+}
+
+void extractTile(const IncrementalOccupancyGrid& grid,
+                 const Eigen::Vector2i& tile,
+                 size_t tile_size,
+                 size_t level,
+                 nav_msgs::OccupancyGrid& msg) {
+  const int scale = 1 << level;
+  const Eigen::Vector2i lower = tile * static_cast<int>(tile_size * scale);
+  extractRegion(grid, lower, Eigen::Vector2i::Constant(tile_size), scale, msg);
+}
+
+void extractWindow(const IncrementalOccupancyGrid& grid,
+                   const Eigen::Vector2d& center,
+                   double window_size,
+                   nav_msgs::OccupancyGrid& msg) {
+  const double resolution = grid.grid().info.resolution;
+  const int cells = std::ceil(window_size / resolution);
+  const Eigen::Vector2i center_cell = (center / resolution).array().floor().cast<int>();
+  const Eigen::Vector2i lower = center_cell - Eigen::Vector2i::Constant(cells / 2);
+  extractRegion(grid, lower, Eigen::Vector2i::Constant(cells), 1, msg);
+}
+
+}  // namespace hydra
@@ -129,7 +129,7 @@ BasisPointPlugin::BasisPointPlugin(const Config& config,
   }
 
   // namespacing gives us a reasonable topic
-  pub_ = nh_.advertise<visualization_msgs::MarkerArray>("", 1, true);
+  pub_ = advertise<visualization_msgs::MarkerArray>("", 1);
 }
 
 void BasisPointPlugin::draw(const ConfigManager&,
@@ -35,6 +35,7 @@
 #include "hydra_ros/visualizer/colormap_utilities.h"
 
 #include <algorithm>
+#include <memory>
 #include <opencv2/imgproc.hpp>
 
 namespace hydra::dsg_utils {
@@ -60,4 +61,59 @@ Color interpolateColorMap(const ColormapConfig& config, double ratio) {
   return Color::fromHLS(hue, luminance, saturation);
 }
 
+ColormapLut::ColormapLut(const ColormapConfig& config, size_t num_entries)
+    : config_(config), max_index_(std::max<size_t>(num_entries, 2) - 1) {
+  const size_t size = max_index_ + 1;
+  colors_.reserve(size);
+  msgs_.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    colors_.push_back(interpolateColorMap(config, i / max_index_));
+    msgs_.push_back(makeColorMsg(colors_.back()));
+  }
+}
+
+void ColormapLut::colorAll(const std::vector<double>& ratios,
+                           double alpha,
+                           std::vector<std_msgs::ColorRGBA>& colors) const {
+  const size_t offset = colors.size();
+  colors.resize(offset + ratios.size());
+  for (size_t i = 0; i < ratios.size(); ++i) {
+    auto& color = colors[offset + i];
+    color = msgs_[getIndex(ratios[i])];
+    color.a = alpha;
+  }
+}
+
+bool ColormapLut::matches(const ColormapConfig& config) const {
+  return config.min_hue == config_.min_hue && config.max_hue == config_.max_hue &&
+         config.min_saturation == config_.min_saturation &&
+         config.max_saturation == config_.max_saturation &&
+         config.min_luminance == config_.min_luminance &&
+         config.max_luminance == config_.max_luminance;
+}
+
+const ColormapLut& getColormapLut(const ColormapConfig& config) {
+  // most callers only ever use a handful of colormaps
+  constexpr size_t max_tables = 8;
+  thread_local std::vector<std::unique_ptr<ColormapLut>> tables;
+  thread_local size_t next_slot = 0;
+  for (const auto& table : tables) {
+    if (table->matches(config)) {
+      return *table;
+    }
+  }
+
+  auto table = std::make_unique<ColormapLut>(config);
+  if (tables.size() < max_tables) {
+    tables.push_back(std::move(table));
+    return *tables.back();
+  }
+
+  // evict in insertion order
+  auto& slot = tables[next_slot];
+  next_slot = (next_slot + 1) % max_tables;
+  slot = std::move(table);
+  return *slot;
+}
+
 }  // namespace hydra::dsg_utils
@@ -39,7 +39,8 @@
 
 namespace hydra {
 
-ConfigManager::ConfigManager(const ros::NodeHandle& nh) : nh_(nh) {}
+ConfigManager::ConfigManager(const ros::NodeHandle& nh)
+    : nh_(nh), generation_(0), cleared_generation_(0), global_generation_(0) {}
 
 ConfigManager::~ConfigManager() {
   visualizer_config_.reset();
@@ -49,7 +50,8 @@ ConfigManager::~ConfigManager() {
 }
 
 void ConfigManager::reset() {
-  visualizer_config_ = std::make_shared<ConfigWrapper<VisualizerConfig>>(nh_, "config");
+  visualizer_config_ = makeConfig<VisualizerConfig>(
+      "config", [this]() { recordChange(nullptr, 0); });
   layer_configs_.clear();
   dynamic_layer_configs_.clear();
   colormaps_.clear();
@@ -59,95 +61,103 @@ void ConfigManager::reset(const DynamicSceneGraph& graph) {
   reset();
   for (const auto layer : graph.layer_ids) {
     const auto ns = "config/layer" + std::to_string(layer);
-    layer_configs_.emplace(layer,
-                           std::make_shared<ConfigWrapper<LayerConfig>>(nh_, ns));
+    layer_configs_.emplace(layer, makeConfig<LayerConfig>(ns, [this, layer]() {
+                             recordChange(&layer_generations_, layer);
+                           }));
   }
 
   for (const auto& id_layer_pair : graph.dynamicLayers()) {
-    const auto ns = "config/dynamic_layers/" + std::to_string(id_layer_pair.first);
+    const auto layer = id_layer_pair.first;
+    const auto ns = "config/dynamic_layers/" + std::to_string(layer);
     dynamic_layer_configs_.emplace(
-        id_layer_pair.first,
-        std::make_shared<ConfigWrapper<DynamicLayerConfig>>(nh_, ns));
+        layer, makeConfig<DynamicLayerConfig>(ns, [this, layer]() {
+          recordChange(&dynamic_layer_generations_, layer);
+        }));
   }
 }
 
-bool ConfigManager::hasChange() const {
-  bool has_changed = visualizer_config_->hasChange();
+bool ConfigManager::hasChange() const { return generation_ != cleared_generation_; }
 
-  for (const auto& id_config_pair : layer_configs_) {
-    has_changed |= id_config_pair.second->hasChange();
-  }
-
-  for (const auto& id_config_pair : dynamic_layer_configs_) {
-    has_changed |= id_config_pair.second->hasChange();
-  }
-
-  for (const auto& name_config_pair : colormaps_) {
-    has_changed |= name_config_pair.second->hasChange();
-  }
-
-  return has_changed;
-}
-
-void ConfigManager::clearChangeFlags() {
-  visualizer_config_->clearChangeFlag();
-  for (auto& id_config_pair : layer_configs_) {
-    id_config_pair.second->clearChangeFlag();
-  }
-
-  for (auto& id_config_pair : dynamic_layer_configs_) {
-    id_config_pair.second->clearChangeFlag();
-  }
-
-  for (auto& name_config_pair : colormaps_) {
-    name_config_pair.second->clearChangeFlag();
-  }
-}
+void ConfigManager::clearChangeFlags() { cleared_generation_ = generation_; }
 
 const VisualizerConfig& ConfigManager::getVisualizerConfig() const {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (!visualizer_config_) {
-    visualizer_config_ =
-        std::make_shared<ConfigWrapper<VisualizerConfig>>(nh_, "config");
+    visualizer_config_ = makeConfig<VisualizerConfig>(
+        "config", [this]() { recordChange(nullptr, 0); });
   }
 
   return visualizer_config_->get();
 }
 
 const LayerConfig* ConfigManager::getLayerConfig(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = layer_configs_.find(layer);
   if (iter == layer_configs_.end()) {
     const auto ns = "config/layer" + std::to_string(layer);
-    iter = layer_configs_
-               .emplace(layer, std::make_shared<ConfigWrapper<LayerConfig>>(nh_, ns))
-               .first;
+    auto config = makeConfig<LayerConfig>(
+        ns, [this, layer]() { recordChange(&layer_generations_, layer); });
+    iter = layer_configs_.emplace(layer, config).first;
   }
 
   return &(iter->second->get());
 }
 
 const DynamicLayerConfig& ConfigManager::getDynamicLayerConfig(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = dynamic_layer_configs_.find(layer);
   if (iter == dynamic_layer_configs_.end()) {
     const std::string ns = "config/dynamic_layer/" + std::to_string(layer);
-    iter = dynamic_layer_configs_
-               .emplace(layer,
-                        std::make_shared<ConfigWrapper<DynamicLayerConfig>>(nh_, ns))
-               .first;
+    auto config = makeConfig<DynamicLayerConfig>(
+        ns, [this, layer]() { recordChange(&dynamic_layer_generations_, layer); });
+    iter = dynamic_layer_configs_.emplace(layer, config).first;
   }
 
   return iter->second->get();
 }
 
 const ColormapConfig& ConfigManager::getColormapConfig(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = colormaps_.find(name);
   if (iter == colormaps_.end()) {
     const std::string ns = "config/" + name;
-    iter = colormaps_
-               .emplace(name, std::make_shared<ConfigWrapper<ColormapConfig>>(nh_, ns))
-               .first;
+    auto config =
+        makeConfig<ColormapConfig>(ns, [this]() { recordChange(nullptr, 0); });
+    iter = colormaps_.emplace(name, config).first;
   }
 
   return iter->second->get();
 }
 
+uint64_t ConfigManager::getGlobalGeneration() const {
+  std::lock_guard<std::mutex> lock(generation_mutex_);
+  return global_generation_;
+}
+
+uint64_t ConfigManager::getLayerGeneration(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(generation_mutex_);
+  auto iter = layer_generations_.find(layer);
+  return iter == layer_generations_.end() ? 0 : iter->second;
+}
+
+uint64_t ConfigManager::getDynamicLayerGeneration(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(generation_mutex_);
+  auto iter = dynamic_layer_generations_.find(layer);
+  return iter == dynamic_layer_generations_.end() ? 0 : iter->second;
+}
+
+void ConfigManager::recordChange(std::map<LayerId, uint64_t>* generations,
+                                 LayerId layer) const {
+  std::lock_guard<std::mutex> lock(generation_mutex_);
+  const uint64_t generation = generation_ + 1;
+  if (generations) {
+    (*generations)[layer] = generation;
+  } else {
+    global_generation_ = generation;
+  }
+
+  // only publish the new generation once the stamps are visible
+  generation_ = generation;
+}
+
 }  // namespace hydra
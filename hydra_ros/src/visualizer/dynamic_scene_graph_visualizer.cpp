@@ -35,9 +35,13 @@
 #include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
 
 #include <glog/logging.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
 #include <spark_dsg/node_attributes.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+#include <thread>
+
 #include "hydra_ros/visualizer/colormap_utilities.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
 
@@ -74,15 +78,143 @@ void clearPrevMarkers(const std_msgs::Header& header,
   prev_nodes = curr_nodes;
 }
 
+template <typename Derived>
+void hashMatrix(size_t& seed, const Eigen::MatrixBase<Derived>& mat) {
+  for (int r = 0; r < mat.rows(); ++r) {
+    for (int c = 0; c < mat.cols(); ++c) {
+      hashCombine(seed, std::hash<double>()(static_cast<double>(mat(r, c))));
+    }
+  }
+}
+
+// hashes the attribute fields read by the layer marker builders and color modes
+void hashAttributes(size_t& seed, const NodeAttributes& attrs) {
+  hashPosition(seed, attrs.position);
+  hashCombine(seed, attrs.last_update_time_ns);
+  hashCombine(seed, attrs.is_active);
+
+  const auto semantic = dynamic_cast<const SemanticNodeAttributes*>(&attrs);
+  if (!semantic) {
+    return;
+  }
+
+  const auto& color = semantic->color;
+  const size_t packed = (static_cast<size_t>(color.r) << 24) |
+                        (static_cast<size_t>(color.g) << 16) |
+                        (static_cast<size_t>(color.b) << 8) | color.a;
+  hashCombine(seed, packed);
+  hashCombine(seed, std::hash<std::string>()(semantic->name));
+  hashCombine(seed, semantic->semantic_label);
+  hashMatrix(seed, semantic->bounding_box.dimensions);
+  hashMatrix(seed, semantic->bounding_box.world_P_center);
+  hashMatrix(seed, semantic->bounding_box.world_R_center);
+
+  const auto frontier = dynamic_cast<const FrontierNodeAttributes*>(&attrs);
+  if (frontier) {
+    hashCombine(seed, frontier->real_place);
+    hashCombine(seed, frontier->is_predicted);
+    hashCombine(seed, frontier->active_frontier);
+    hashMatrix(seed, frontier->frontier_scale);
+    hashMatrix(seed, frontier->orientation.coeffs());
+    return;
+  }
+
+  const auto place = dynamic_cast<const PlaceNodeAttributes*>(&attrs);
+  if (place) {
+    hashCombine(seed, std::hash<double>()(place->distance));
+    hashCombine(seed, place->real_place);
+    return;
+  }
+
+  const auto place_2d = dynamic_cast<const Place2dNodeAttributes*>(&attrs);
+  if (place_2d) {
+    hashCombine(seed, place_2d->boundary.size());
+    for (const auto& point : place_2d->boundary) {
+      hashPosition(seed, point);
+    }
+
+    hashMatrix(seed, place_2d->ellipse_centroid);
+    hashMatrix(seed, place_2d->ellipse_matrix_expand);
+    hashCombine(seed, place_2d->pcl_mesh_connections.size());
+    hashCombine(seed, place_2d->need_cleanup_splitting);
+    hashCombine(seed, place_2d->has_active_mesh_indices);
+  }
+}
+
+// cheap summary of everything in a layer that the layer markers depend on
+size_t getLayerFingerprint(const SceneGraphLayer& layer) {
+  size_t seed = 0;
+  hashCombine(seed, layer.numNodes());
+  hashCombine(seed, layer.numEdges());
+  for (const auto& [node_id, node] : layer.nodes()) {
+    hashCombine(seed, node_id);
+    hashAttributes(seed, node->attributes());
+    hashCombine(seed, node->getParent().value_or(0));
+  }
+
+  for (const auto& [key, edge] : layer.edges()) {
+    hashCombine(seed, edge.source);
+    hashCombine(seed, edge.target);
+  }
+
+  return seed;
+}
+
+size_t getInterlayerFingerprint(const DynamicSceneGraph& graph) {
+  size_t seed = 0;
+  for (const auto& [key, edge] : graph.interlayer_edges()) {
+    hashCombine(seed, edge.source);
+    hashCombine(seed, edge.target);
+  }
+
+  return seed;
+}
+
+size_t getDynamicFingerprint(const DynamicSceneGraph& graph) {
+  size_t seed = 0;
+  for (const auto& [layer_id, sublayers] : graph.dynamicLayers()) {
+    for (const auto& [prefix, layer] : sublayers) {
+      hashCombine(seed, layer_id);
+      hashCombine(seed, prefix);
+      hashCombine(seed, layer->numNodes());
+      hashCombine(seed, layer->numEdges());
+      // loop closures can move any pose, so every position is hashed
+      for (size_t i = 0; i < layer->numNodes(); ++i) {
+        hashPosition(seed, layer->getPositionByIndex(i));
+      }
+    }
+  }
+
+  hashCombine(seed, graph.dynamic_interlayer_edges().size());
+  return seed;
+}
+
 DynamicSceneGraphVisualizer::DynamicSceneGraphVisualizer(const ros::NodeHandle& nh)
-    : nh_(nh), need_redraw_(false), periodic_redraw_(false), visualizer_frame_("map") {
+    : nh_(nh),
+      need_redraw_(false),
+      periodic_redraw_(false),
+      visualizer_frame_("map"),
+      redraw_all_(true),
+      republish_cached_(false),
+      lod_view_frame_("rotated_view") {
   nh_.param("visualizer_frame", visualizer_frame_, visualizer_frame_);
+  nh_.param("lod_view_frame", lod_view_frame_, lod_view_frame_);
+  int num_draw_threads = 4;
+  nh_.param("num_draw_threads", num_draw_threads, num_draw_threads);
+  num_draw_threads_ = std::max(num_draw_threads, 1);
 
   std::string config_ns = "~";
   nh_.param("config_ns", config_ns, config_ns);
   config_manager_ = std::make_shared<ConfigManager>(ros::NodeHandle(config_ns));
 
-  dsg_pub_ = nh_.advertise<MarkerArray>("dsg_markers", 1, true);
+  // only changed markers get published, so new subscribers need everything we have
+  dsg_pub_ = nh_.advertise<MarkerArray>(
+      "dsg_markers",
+      1,
+      [this](const ros::SingleSubscriberPublisher&) { republish_cached_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      true);
   dynamic_layers_viz_pub_ = nh_.advertise<MarkerArray>("dynamic_layers_viz", 1, true);
 }
 
@@ -118,12 +250,31 @@ bool DynamicSceneGraphVisualizer::redraw() {
     return false;
   }
 
-  need_redraw_ |= config_manager_->hasChange();
+  // layer config changes show up in the layer fingerprints, so only changes to the
+  // shared configs need everything redrawn
+  const auto config_generation = config_manager_->generation();
+  if (config_generation != last_config_generation_) {
+    need_redraw_ = true;
+    if (config_manager_->getGlobalGeneration() > last_config_generation_) {
+      redraw_all_ = true;
+    }
+
+    last_config_generation_ = config_generation;
+  }
+
+  updateLodView();
+
   for (const auto& plugin : plugins_) {
-    need_redraw_ |= plugin->hasChange();
+    if (plugin->hasChange() || plugin->hasPendingDraw()) {
+      need_redraw_ = true;
+    }
   }
 
   if (!need_redraw_) {
+    if (republish_cached_.exchange(false)) {
+      publishCached();
+    }
+
     return false;
   }
 
@@ -135,12 +286,19 @@ bool DynamicSceneGraphVisualizer::redraw() {
 
   MarkerArray msg;
   redrawImpl(header, msg);
+  redraw_all_ = false;
 
   if (!msg.markers.empty()) {
     dsg_pub_.publish(msg);
   }
 
-  config_manager_->clearChangeFlags();
+  // hand the point buffers back so the next redraw doesn't have to reallocate them
+  marker_buffers_.release(msg);
+
+  if (republish_cached_.exchange(false)) {
+    publishCached();
+  }
+
   for (auto& plugin : plugins_) {
     plugin->clearChangeFlag();
   }
@@ -168,6 +326,8 @@ void DynamicSceneGraphVisualizer::setGraph(const DynamicSceneGraph::Ptr& scene_g
     }
   }
 
+  // marker caches are keyed on graph contents, so swapping in a newer copy of the
+  // same graph only redraws what actually changed
   scene_graph_ = scene_graph;
   need_redraw_ = true;
 }
@@ -208,8 +368,9 @@ void DynamicSceneGraphVisualizer::drawDynamicLayer(const std_msgs::Header& heade
                                             viz_config,
                                             getNodeColor(config, layer.prefix),
                                             node_ns,
-                                            viz_idx);
-  addMultiMarkerIfValid(nodes, msg);
+                                            viz_idx,
+                                            &marker_buffers_);
+  addMultiMarkerIfValid(std::move(nodes), msg);
 
   const std::string edge_ns = getDynamicEdgeNamespace(layer.prefix);
   Marker edges = makeDynamicEdgeMarkers(header,
@@ -218,8 +379,9 @@ void DynamicSceneGraphVisualizer::drawDynamicLayer(const std_msgs::Header& heade
                                         viz_config,
                                         getEdgeColor(config, layer.prefix),
                                         edge_ns,
-                                        viz_idx);
-  addMultiMarkerIfValid(edges, msg);
+                                        viz_idx,
+                                        &marker_buffers_);
+  addMultiMarkerIfValid(std::move(edges), msg);
 
   if (layer.numNodes() == 0) {
     deleteLabel(header, layer.prefix, msg);
@@ -296,6 +458,11 @@ void DynamicSceneGraphVisualizer::resetImpl(const std_msgs::Header& header,
     label_set.second.clear();
   }
 
+  const auto to_clear = published_clouds_;
+  for (const auto layer_id : to_clear) {
+    clearLayerCloud(header, layer_id);
+  }
+
   // vanilla scene graph also makes delete markers for dynamic layers, so we duplicate
   // them here (rviz checks for topic / namespace coherence)
   MarkerArray dynamic_msg = msg;
@@ -310,6 +477,10 @@ void DynamicSceneGraphVisualizer::resetImpl(const std_msgs::Header& header,
   }
 
   published_dynamic_labels_.clear();
+  marker_caches_.clear();
+  dynamic_marker_cache_ = MarkerCache();
+  marker_buffers_.clear();
+  redraw_all_ = true;
 
   for (const auto& plugin : plugins_) {
     plugin->reset(header, *scene_graph_);
@@ -324,21 +495,82 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
   }
 
   const auto& visualizer_config = config_manager_->getVisualizerConfig();
+
+  // moving the view changes what every layer draws
+  size_t lod_fingerprint = 0;
+  if (lod_view_) {
+    hashCombine(lod_fingerprint, std::hash<double>()(lod_view_->x()));
+    hashCombine(lod_fingerprint, std::hash<double>()(lod_view_->y()));
+  }
+
+  std::map<LayerId, size_t> fingerprints;
+  std::set<LayerId> changed_layers;
+  for (auto&& [layer_id, layer] : scene_graph_->layers()) {
+    fingerprints[layer_id] = getLayerFingerprint(*layer);
+    hashCombine(fingerprints[layer_id], lod_fingerprint);
+    hashCombine(fingerprints[layer_id], config_manager_->getLayerGeneration(layer_id));
+    if (redraw_all_ ||
+        !isCached(getLayerNodeNamespace(layer_id), fingerprints.at(layer_id))) {
+      changed_layers.insert(layer_id);
+    }
+  }
+
+  // every group draws into its own buffer so that groups can be built concurrently
+  std::vector<DrawTask> tasks;
   for (auto&& [layer_id, layer] : scene_graph_->layers()) {
     const auto layer_config = config_manager_->getLayerConfig(layer_id);
     if (!layer_config) {
       continue;
     }
 
+    const auto cache_key = getLayerNodeNamespace(layer_id);
     if (!layer_config->visualize) {
       deleteLayer(header, *layer, msg);
+      clearLayerCloud(header, layer_id);
+      marker_caches_.erase(cache_key);
+      continue;
+    }
+
+    // custom color functions and parent colors can depend on any part of the graph
+    const auto color_mode = static_cast<NodeColorMode>(layer_config->marker_color_mode);
+    const bool needs_draw =
+        changed_layers.count(layer_id) || layer_colors_.count(layer_id) ||
+        (color_mode == NodeColorMode::PARENT && !changed_layers.empty());
+    if (!needs_draw) {
+      continue;
+    }
+
+    // publishers are set up here so that drawing the layer only reads cloud_pubs_
+    if (layer_config->use_point_cloud) {
+      if (!cloud_pubs_.count(layer_id)) {
+        cloud_pubs_[layer_id] =
+            nh_.advertise<sensor_msgs::PointCloud2>(cache_key, 1, true);
+      }
+
+      published_clouds_.insert(layer_id);
     } else {
-      drawLayer(header, *layer, *layer_config, msg);
+      clearLayerCloud(header, layer_id);
     }
+
+    const SceneGraphLayer* layer_ptr = layer.get();
+    tasks.push_back({cache_key,
+                     fingerprints.at(layer_id),
+                     [this, &header, layer_ptr, layer_config](MarkerArray& markers) {
+                       drawLayer(header, *layer_ptr, *layer_config, markers);
+                     }});
   }
 
-  if (visualizer_config.draw_mesh_edges) {
-    drawLayerMeshEdges(header, mesh_edge_source_layer_, mesh_edge_ns_, msg);
+  if (visualizer_config.draw_mesh_edges &&
+      scene_graph_->hasLayer(mesh_edge_source_layer_)) {
+    const auto mesh = scene_graph_->mesh();
+    size_t fingerprint = fingerprints.at(mesh_edge_source_layer_);
+    hashCombine(fingerprint, mesh ? mesh->numVertices() : 0);
+    if (redraw_all_ || !isCached(mesh_edge_ns_, fingerprint)) {
+      const auto draw = [this, &header](MarkerArray& markers) {
+        drawLayerMeshEdges(header, mesh_edge_source_layer_, mesh_edge_ns_, markers);
+      };
+      tasks.push_back({mesh_edge_ns_, fingerprint, draw});
+    }
   }
 
   std::map<LayerId, LayerConfig> all_configs;
@@ -346,17 +578,104 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
     all_configs[layer_id] = *CHECK_NOTNULL(config_manager_->getLayerConfig(layer_id));
   }
 
+  // interlayer edges move with the nodes of every layer
+  size_t interlayer_fingerprint = getInterlayerFingerprint(*scene_graph_);
+  for (const auto& [layer_id, fingerprint] : fingerprints) {
+    hashCombine(interlayer_fingerprint, fingerprint);
+  }
+
+  if (redraw_all_ || !isCached(interlayer_edge_ns_prefix_, interlayer_fingerprint)) {
+    tasks.push_back({interlayer_edge_ns_prefix_,
+                     interlayer_fingerprint,
+                     [this, &header, &all_configs](MarkerArray& markers) {
+                       drawInterlayerEdges(header, all_configs, markers);
+                     }});
+  }
+
+  const std::string dynamic_interlayer_edge_prefix = "dynamic_interlayer_edges_";
+  size_t dynamic_fingerprint = getDynamicFingerprint(*scene_graph_);
+  hashCombine(dynamic_fingerprint, interlayer_fingerprint);
+  for (const auto& id_layer_pair : scene_graph_->dynamicLayers()) {
+    const auto layer_id = id_layer_pair.first;
+    hashCombine(dynamic_fingerprint,
+                config_manager_->getDynamicLayerGeneration(layer_id));
+  }
+  std::unique_ptr<MarkerArray> dynamic_markers;
+  if (redraw_all_ || !isCached(dynamic_interlayer_edge_prefix, dynamic_fingerprint)) {
+    dynamic_markers = std::make_unique<MarkerArray>();
+    tasks.push_back({dynamic_interlayer_edge_prefix,
+                     dynamic_fingerprint,
+                     [&](MarkerArray& markers) {
+                       drawDynamicLayers(header, *dynamic_markers);
+                       drawDynamicEdges(header,
+                                        all_configs,
+                                        dynamic_interlayer_edge_prefix,
+                                        markers);
+                     }});
+  }
+
+  // plugins publish on their own, so they only need to run alongside everything else
+  for (const auto& plugin : plugins_) {
+    tasks.push_back({"", 0, [this, &header, plugin](MarkerArray&) {
+                       plugin->drawIfNeeded(*config_manager_, header, *scene_graph_);
+                     }});
+  }
+
+  std::atomic<size_t> next(0);
+  const auto worker = [&]() {
+    size_t i;
+    while ((i = next++) < tasks.size()) {
+      tasks[i].draw(tasks[i].markers);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(num_draw_threads_, tasks.size()); ++i) {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // merge in the order the tasks were created so the output doesn't depend on timing
+  for (auto& task : tasks) {
+    if (!task.key.empty()) {
+      addCachedMarkers(task.key, task.fingerprint, task.markers, msg);
+    }
+  }
+
+  if (!dynamic_markers) {
+    return;
+  }
+
+  if (!dynamic_markers->markers.empty()) {
+    dynamic_layers_viz_pub_.publish(*dynamic_markers);
+  }
+
+  updateCache(*dynamic_markers, dynamic_marker_cache_.markers);
+  marker_buffers_.release(*dynamic_markers);
+}
+
+void DynamicSceneGraphVisualizer::drawInterlayerEdges(
+    const std_msgs::Header& header,
+    const std::map<LayerId, LayerConfig>& all_configs,
+    MarkerArray& msg) {
+  const auto& visualizer_config = config_manager_->getVisualizerConfig();
   MarkerArray interlayer_edge_markers =
       makeGraphEdgeMarkers(header,
                            *scene_graph_,
                            all_configs,
                            visualizer_config,
-                           interlayer_edge_ns_prefix_);
+                           interlayer_edge_ns_prefix_,
+                           getLodEdgeFilter(visualizer_config),
+                           &marker_buffers_);
 
   std::set<std::string> seen_edge_labels;
-  for (const auto& marker : interlayer_edge_markers.markers) {
-    addMultiMarkerIfValid(marker, msg);
+  for (auto& marker : interlayer_edge_markers.markers) {
     seen_edge_labels.insert(marker.ns);
+    addMultiMarkerIfValid(std::move(marker), msg);
   }
 
   for (const auto& source_pair : all_configs) {
@@ -375,29 +694,33 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
       deleteMultiMarker(header, curr_ns, msg);
     }
   }
+}
 
-  MarkerArray dynamic_markers;
-  drawDynamicLayers(header, dynamic_markers);
-
+void DynamicSceneGraphVisualizer::drawDynamicEdges(
+    const std_msgs::Header& header,
+    const std::map<LayerId, LayerConfig>& all_configs,
+    const std::string& dynamic_interlayer_edge_prefix,
+    MarkerArray& msg) {
+  const auto& visualizer_config = config_manager_->getVisualizerConfig();
   std::map<LayerId, DynamicLayerConfig> all_dynamic_configs;
   for (const auto& id_layer_pair : scene_graph_->dynamicLayers()) {
     const auto layer_id = id_layer_pair.first;
     all_dynamic_configs[layer_id] = config_manager_->getDynamicLayerConfig(layer_id);
   }
 
-  const std::string dynamic_interlayer_edge_prefix = "dynamic_interlayer_edges_";
   MarkerArray dynamic_interlayer_edge_markers =
       makeDynamicGraphEdgeMarkers(header,
                                   *scene_graph_,
                                   all_configs,
                                   all_dynamic_configs,
                                   visualizer_config,
-                                  dynamic_interlayer_edge_prefix);
+                                  dynamic_interlayer_edge_prefix,
+                                  &marker_buffers_);
 
   std::set<std::string> seen_dyn_edge_labels;
-  for (const auto& marker : dynamic_interlayer_edge_markers.markers) {
-    addMultiMarkerIfValid(marker, msg);
+  for (auto& marker : dynamic_interlayer_edge_markers.markers) {
     seen_dyn_edge_labels.insert(marker.ns);
+    addMultiMarkerIfValid(std::move(marker), msg);
   }
 
   for (const auto& source_pair : all_configs) {
@@ -417,19 +740,12 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
       }
     }
   }
-
-  if (!dynamic_markers.markers.empty()) {
-    dynamic_layers_viz_pub_.publish(dynamic_markers);
-  }
-
-  for (const auto& plugin : plugins_) {
-    plugin->draw(*config_manager_, header, *scene_graph_);
-  }
 }
 
 void DynamicSceneGraphVisualizer::deleteMultiMarker(const std_msgs::Header& header,
                                                     const std::string& ns,
                                                     MarkerArray& msg) {
+  std::lock_guard<std::mutex> lock(published_mutex_);
   if (!published_multimarkers_.count(ns)) {
     return;
   }
@@ -440,17 +756,76 @@ void DynamicSceneGraphVisualizer::deleteMultiMarker(const std_msgs::Header& head
   published_multimarkers_.erase(ns);
 }
 
-void DynamicSceneGraphVisualizer::addMultiMarkerIfValid(const Marker& marker,
+void DynamicSceneGraphVisualizer::addMultiMarkerIfValid(Marker marker,
                                                         MarkerArray& msg) {
   if (!marker.points.empty()) {
-    msg.markers.push_back(marker);
-    published_multimarkers_.insert(marker.ns);
+    {  // scope for lock
+      std::lock_guard<std::mutex> lock(published_mutex_);
+      published_multimarkers_.insert(marker.ns);
+    }
+
+    msg.markers.push_back(std::move(marker));
     return;
   }
 
   deleteMultiMarker(marker.header, marker.ns, msg);
 }
 
+void DynamicSceneGraphVisualizer::addCachedMarkers(const std::string& key,
+                                                   size_t fingerprint,
+                                                   MarkerArray& markers,
+                                                   MarkerArray& msg) {
+  auto& cache = marker_caches_[key];
+  cache.fingerprint = fingerprint;
+  updateCache(markers, cache.markers);
+  for (auto& marker : markers.markers) {
+    msg.markers.push_back(std::move(marker));
+  }
+}
+
+void DynamicSceneGraphVisualizer::updateCache(const MarkerArray& markers,
+                                              MarkerArray& cache) const {
+  // assign in place so the cached markers keep their point storage between redraws
+  size_t num_cached = 0;
+  for (const auto& marker : markers.markers) {
+    if (marker.action == Marker::DELETE) {
+      continue;
+    }
+
+    if (num_cached < cache.markers.size()) {
+      cache.markers[num_cached] = marker;
+    } else {
+      cache.markers.push_back(marker);
+    }
+
+    ++num_cached;
+  }
+
+  cache.markers.resize(num_cached);
+}
+
+bool DynamicSceneGraphVisualizer::isCached(const std::string& key,
+                                           size_t fingerprint) const {
+  auto iter = marker_caches_.find(key);
+  return iter != marker_caches_.end() && iter->second.fingerprint == fingerprint;
+}
+
+void DynamicSceneGraphVisualizer::publishCached() {
+  MarkerArray msg;
+  for (const auto& [key, cache] : marker_caches_) {
+    msg.markers.insert(
+        msg.markers.end(), cache.markers.markers.begin(), cache.markers.markers.end());
+  }
+
+  if (!msg.markers.empty()) {
+    dsg_pub_.publish(msg);
+  }
+
+  if (!dynamic_marker_cache_.markers.markers.empty()) {
+    dynamic_layers_viz_pub_.publish(dynamic_marker_cache_.markers);
+  }
+}
+
 void DynamicSceneGraphVisualizer::displayLoop(const ros::WallTimerEvent&) {
   if (periodic_redraw_) {
     need_redraw_ = true;
@@ -518,6 +893,78 @@ Color DynamicSceneGraphVisualizer::getParentColor(
   return scene_graph_->getNode(*parent).attributes<SemanticNodeAttributes>().color;
 }
 
+void DynamicSceneGraphVisualizer::updateLodView() {
+  const auto& config = config_manager_->getVisualizerConfig();
+  if (!config.use_lod) {
+    lod_view_.reset();
+    return;
+  }
+
+  if (!tf_buffer_) {
+    tf_buffer_ = std::make_unique<tf2_ros::Buffer>();
+    tf_listener_ = std::make_unique<tf2_ros::TransformListener>(*tf_buffer_);
+  }
+
+  geometry_msgs::TransformStamped transform;
+  try {
+    transform =
+        tf_buffer_->lookupTransform(visualizer_frame_, lod_view_frame_, ros::Time(0));
+  } catch (const tf2::TransformException& e) {
+    ROS_WARN_STREAM_THROTTLE(5.0, "Unable to look up LOD view frame: " << e.what());
+    return;
+  }
+
+  const Eigen::Vector2d view(transform.transform.translation.x,
+                             transform.transform.translation.y);
+  if (lod_view_ && (view - *lod_view_).norm() < config.lod_update_distance) {
+    return;
+  }
+
+  lod_view_ = view;
+  need_redraw_ = true;
+}
+
+double DynamicSceneGraphVisualizer::getLodDistance(const SceneGraphNode& node) const {
+  if (!lod_view_) {
+    return 0.0;
+  }
+
+  return (node.attributes().position.head<2>() - *lod_view_).norm();
+}
+
+FilterFunction DynamicSceneGraphVisualizer::getLodNodeFilter(
+    const VisualizerConfig& config) const {
+  if (!lod_view_) {
+    return {};
+  }
+
+  const double cull_radius = config.lod_cull_radius;
+  const double decimation_distance = config.lod_decimation_distance;
+  const NodeId stride = std::max(config.lod_decimation_stride, 1);
+  return [this, cull_radius, decimation_distance, stride](const SceneGraphNode& node) {
+    const double distance = getLodDistance(node);
+    if (distance > cull_radius) {
+      return false;
+    }
+
+    // decimate by id so the same nodes survive as the view moves
+    return distance <= decimation_distance || node.id % stride == 0;
+  };
+}
+
+FilterFunction DynamicSceneGraphVisualizer::getLodEdgeFilter(
+    const VisualizerConfig& config) const {
+  if (!lod_view_) {
+    return {};
+  }
+
+  const double max_distance =
+      std::min(config.lod_cull_radius, config.lod_decimation_distance);
+  return [this, max_distance](const SceneGraphNode& node) {
+    return getLodDistance(node) <= max_distance;
+  };
+}
+
 void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
                                             const SceneGraphLayer& layer,
                                             const LayerConfig& config,
@@ -544,18 +991,19 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
       case NodeColorMode::FRONTIER:
         layer_color_func = getFrontierColor;
         break;
-      case NodeColorMode::DISTANCE:
-        layer_color_func = [&](const SceneGraphNode& node) -> Color {
+      case NodeColorMode::DISTANCE: {
+        const auto& colormap = dsg_utils::getColormapLut(
+            config_manager_->getColormapConfig("places_colormap"));
+        layer_color_func = [&viz_config, &colormap](const SceneGraphNode& node) {
           try {
             return getDistanceColor(
-                viz_config,
-                config_manager_->getColormapConfig("places_colormap"),
-                node.attributes<PlaceNodeAttributes>().distance);
+                viz_config, colormap, node.attributes<PlaceNodeAttributes>().distance);
           } catch (const std::bad_cast&) {
             return Color();
           }
         };
         break;
+      }
       case NodeColorMode::PARENT:
         layer_color_func = [this](const auto& node) { return getParentColor(node); };
         break;
@@ -572,36 +1020,76 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
     }
   }
 
-  if (config.draw_frontier_ellipse) {
+  const auto node_filter = getLodNodeFilter(viz_config);
+  const auto edge_filter = getLodEdgeFilter(viz_config);
+  const auto show_label = [&](const SceneGraphNode& node) {
+    return !lod_view_ || getLodDistance(node) <= viz_config.lod_label_distance;
+  };
+
+  if (config.use_point_cloud) {
+    // the cloud replaces the node marker
+    deleteMultiMarker(header, node_ns, msg);
+    cloud_pubs_.at(layer.id).publish(makeCentroidCloud(
+        header, config, layer, viz_config, layer_color_func, node_filter));
+  } else if (config.draw_frontier_ellipse) {
     std::vector<Marker> ellipsoids = makeEllipsoidMarkers(
         header, config, layer, viz_config, "frontier_ns", layer_color_func);
     for (auto e : ellipsoids) {
       msg.markers.push_back(e);
     }
 
-    auto nodes = makePlaceCentroidMarkers(
-        header, config, layer, viz_config, node_ns, layer_color_func);
-    addMultiMarkerIfValid(nodes, msg);
+    auto nodes = makePlaceCentroidMarkers(header,
+                                          config,
+                                          layer,
+                                          viz_config,
+                                          node_ns,
+                                          layer_color_func,
+                                          node_filter,
+                                          &marker_buffers_);
+    addMultiMarkerIfValid(std::move(nodes), msg);
   } else {
-    auto nodes = makeCentroidMarkers(
-        header, config, layer, viz_config, node_ns, layer_color_func);
-    addMultiMarkerIfValid(nodes, msg);
+    auto nodes = makeCentroidMarkers(header,
+                                     config,
+                                     layer,
+                                     viz_config,
+                                     node_ns,
+                                     layer_color_func,
+                                     node_filter,
+                                     &marker_buffers_);
+    addMultiMarkerIfValid(std::move(nodes), msg);
   }
 
   const std::string edge_ns = getLayerEdgeNamespace(layer.id);
   Marker edges;
-  if (config.color_edges_by_weight) {
+  if (config.use_point_cloud) {
+    edges = makeCompactLayerEdgeMarkers(header,
+                                        config,
+                                        layer,
+                                        viz_config,
+                                        Color(),
+                                        edge_ns,
+                                        edge_filter,
+                                        &marker_buffers_);
+  } else if (config.color_edges_by_weight) {
     edges = makeLayerEdgeMarkers(header,
                                  config,
                                  layer,
                                  viz_config,
                                  config_manager_->getColormapConfig("places_colormap"),
-                                 edge_ns);
+                                 edge_ns,
+                                 edge_filter,
+                                 &marker_buffers_);
   } else {
-    edges = makeLayerEdgeMarkers(
-        header, config, layer, viz_config, Color(), edge_ns);
+    edges = makeLayerEdgeMarkers(header,
+                                 config,
+                                 layer,
+                                 viz_config,
+                                 Color(),
+                                 edge_ns,
+                                 edge_filter,
+                                 &marker_buffers_);
   }
-  addMultiMarkerIfValid(edges, msg);
+  addMultiMarkerIfValid(std::move(edges), msg);
 
   const std::string label_ns = getLayerLabelNamespace(layer.id);
 
@@ -609,7 +1097,7 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
   for (const auto& id_node_pair : layer.nodes()) {
     const Node& node = *id_node_pair.second;
 
-    if (config.use_label) {
+    if (config.use_label && show_label(node)) {
       Marker label = makeTextMarker(header, config, node, viz_config, label_ns);
       msg.markers.push_back(label);
       curr_labels_.at(layer.id).insert(node.id);
@@ -619,6 +1107,9 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
   if (config.use_collapsed_label) {
     for (const auto& id_node_pair : layer.nodes()) {
       const Node& node = *id_node_pair.second;
+      if (!show_label(node)) {
+        continue;
+      }
 
       Marker label = makeTextMarkerNoHeight(header, config, node, viz_config, label_ns, nh_);
       msg.markers.push_back(label);
@@ -631,12 +1122,17 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
   if (config.use_bounding_box) {
     try {
       Marker bbox = makeLayerWireframeBoundingBoxes(
-          header, config, layer, viz_config, bbox_ns, layer_color_func);
+          header, config, layer, viz_config, bbox_ns, layer_color_func, node_filter);
       addMultiMarkerIfValid(bbox, msg);
 
       if (config.collapse_bounding_box) {
-        Marker bbox_edges = makeEdgesToBoundingBoxes(
-            header, config, layer, viz_config, bbox_edge_ns, layer_color_func);
+        Marker bbox_edges = makeEdgesToBoundingBoxes(header,
+                                                     config,
+                                                     layer,
+                                                     viz_config,
+                                                     bbox_edge_ns,
+                                                     layer_color_func,
+                                                     node_filter);
         addMultiMarkerIfValid(bbox_edges, msg);
       } else {
         deleteMultiMarker(header, bbox_edge_ns, msg);
@@ -689,6 +1185,21 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
       header, curr_labels_.at(layer.id), label_ns, prev_labels_.at(layer.id), msg);
 }
 
+void DynamicSceneGraphVisualizer::clearLayerCloud(const std_msgs::Header& header,
+                                                  LayerId layer) {
+  if (!published_clouds_.erase(layer)) {
+    return;
+  }
+
+  // keep the fields so rviz accepts the cloud
+  sensor_msgs::PointCloud2 cloud;
+  cloud.header = header;
+  cloud.height = 1;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+  cloud_pubs_.at(layer).publish(cloud);
+}
+
 void DynamicSceneGraphVisualizer::drawLayerMeshEdges(const std_msgs::Header& header,
                                                      LayerId layer_id,
                                                      const std::string& ns,
@@ -712,8 +1223,9 @@ void DynamicSceneGraphVisualizer::drawLayerMeshEdges(const std_msgs::Header& hea
                                           config_manager_->getVisualizerConfig(),
                                           *scene_graph_,
                                           scene_graph_->getLayer(layer_id),
-                                          ns);
-  addMultiMarkerIfValid(mesh_edges, msg);
+                                          ns,
+                                          &marker_buffers_);
+  addMultiMarkerIfValid(std::move(mesh_edges), msg);
 }
 
 }  // namespace hydra
@@ -80,7 +80,7 @@ FootprintPlugin::FootprintPlugin(const Config& config,
                                  const std::string& name)
     : DsgVisualizerPlugin(nh, name), config(config::checkValid(config)) {
   // namespacing gives us a reasonable topic
-  pub_ = nh_.advertise<visualization_msgs::MarkerArray>("", 1, true);
+  pub_ = advertise<visualization_msgs::MarkerArray>("", 1);
 }
 
 FootprintPlugin::~FootprintPlugin() {}
@@ -129,8 +129,10 @@ void FootprintPlugin::draw(const ConfigManager&,
   }
 
   const auto& layer = graph.getLayer(config.layer_id);
+  // heights are averaged over the edge-connected neighbors of each place
+  const auto mean_heights = getMeanNeighborHeights(layer);
   for (auto&& [id, node] : layer.nodes()) {
-    const auto mean_z = getMeanNeighborHeight(layer, *node);
+    const auto mean_z = mean_heights.at(id);
     const auto& attrs = node->attributes<SemanticNodeAttributes>();
 
     auto color = dsg_utils::makeColorMsg(attrs.color);
@@ -141,13 +143,19 @@ void FootprintPlugin::draw(const ConfigManager&,
       radius = node->attributes<PlaceNodeAttributes>().distance;
     }
 
-    const auto footprint = getCirclePolygon(*node, radius, config.num_samples);
+    size_t fingerprint = 0;
+    hashPosition(fingerprint, node->attributes().position);
+    hashCombine(fingerprint, std::hash<double>()(radius));
+    const auto& footprint =
+        polygons_.get(id, fingerprint, [&](CachedPolygon& polygon) {
+          polygon.points = getCirclePolygon(*node, radius, config.num_samples);
+        });
 
     auto mesh_color = color;
     mesh_color.a = config.mesh_alpha;
-    makeFilledPolygon(footprint, mesh_color, msg.markers[0], mean_z);
+    addFilledPolygon(footprint, mesh_color, msg.markers[0], mean_z);
     if (config.draw_boundaries) {
-      makePolygonBoundary(footprint,
+      makePolygonBoundary(footprint.points,
                           color,
                           msg.markers[1],
                           mean_z,
@@ -155,6 +163,7 @@ void FootprintPlugin::draw(const ConfigManager&,
     }
   }
 
+  polygons_.prune();
   for (const auto& marker : msg.markers) {
     namespaces_.insert(marker.ns);
   }
@@ -168,6 +177,7 @@ void FootprintPlugin::reset(const std_msgs::Header& header, const DynamicSceneGr
     msg.markers.push_back(makeDeleteMarker(header, 0, ns));
   }
   namespaces_.clear();
+  polygons_.clear();
 
   pub_.publish(msg);
 }
@@ -75,7 +75,7 @@ GtRegionPlugin::GtRegionPlugin(const Config& config,
                                const std::string& name)
     : DsgVisualizerPlugin(nh, name), config(config::checkValid(config)) {
   // namespacing gives us a reasonable topic
-  pub_ = nh_.advertise<visualization_msgs::MarkerArray>("", 1, true);
+  pub_ = advertise<visualization_msgs::MarkerArray>("", 1);
 
   std::filesystem::path region_path(config.gt_regions_filepath);
   if (!std::filesystem::exists(region_path)) {
@@ -117,6 +117,8 @@ Marker makeGvdMarker(const GvdVisualizerConfig& config,
   marker.scale.y = layer.voxel_size;
   marker.scale.z = layer.voxel_size;
 
+  // colored in one pass once all voxels are collected
+  std::vector<double> ratios;
   for (const auto& block : layer) {
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
@@ -129,14 +131,12 @@ Marker makeGvdMarker(const GvdVisualizerConfig& config,
       tf2::convert(voxel_pos, marker_pos);
       marker.points.push_back(marker_pos);
 
-      double ratio = getRatio(config, voxel);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
-
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
-      marker.colors.push_back(color_msg);
+      ratios.push_back(getRatio(config, voxel));
     }
   }
 
+  dsg_utils::getColormapLut(colors).colorAll(ratios, config.gvd_alpha, marker.colors);
+
   return marker;
 }
 
@@ -159,6 +159,7 @@ Marker makeErrorMarker(const GvdVisualizerConfig& config,
   marker.scale.y = lhs.voxel_size;
   marker.scale.z = lhs.voxel_size;
 
+  std::vector<double> ratios;
   for (const auto& lhs_block : lhs) {
     const auto& rhs_block = rhs.getBlock(lhs_block.index);
 
@@ -175,19 +176,16 @@ Marker makeErrorMarker(const GvdVisualizerConfig& config,
         continue;
       }
 
-      double ratio = computeRatio(0, 10, error);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
-
       const Eigen::Vector3d voxel_pos = lhs_block.getVoxelPosition(i).cast<double>();
       geometry_msgs::Point marker_pos;
       tf2::convert(voxel_pos, marker_pos);
       marker.points.push_back(marker_pos);
-
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
-      marker.colors.push_back(color_msg);
+      ratios.push_back(computeRatio(0, 10, error));
     }
   }
 
+  dsg_utils::getColormapLut(colors).colorAll(ratios, config.gvd_alpha, marker.colors);
+
   return marker;
 }
 
@@ -208,6 +206,7 @@ Marker makeSurfaceVoxelMarker(const GvdVisualizerConfig& config,
   marker.scale.y = layer.voxel_size;
   marker.scale.z = layer.voxel_size;
 
+  std::vector<double> ratios;
   for (const auto& block : layer) {
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
@@ -220,14 +219,12 @@ Marker makeSurfaceVoxelMarker(const GvdVisualizerConfig& config,
       tf2::convert(voxel_pos, marker_pos);
       marker.points.push_back(marker_pos);
 
-      double ratio = computeRatio(-0.4, 0.4, voxel.distance);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
-
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
-      marker.colors.push_back(color_msg);
+      ratios.push_back(computeRatio(-0.4, 0.4, voxel.distance));
     }
   }
 
+  dsg_utils::getColormapLut(colors).colorAll(ratios, config.gvd_alpha, marker.colors);
+
   return marker;
 }
 
@@ -254,6 +251,7 @@ Marker makeEsdfMarker(const GvdVisualizerConfig& config,
   const float slice_height =
       std::floor(config.slice_height / voxel_size) * voxel_size + half_voxel_size;
 
+  std::vector<double> ratios;
   for (const auto& block : layer) {
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
@@ -271,15 +269,13 @@ Marker makeEsdfMarker(const GvdVisualizerConfig& config,
       tf2::convert(voxel_pos, marker_pos);
       marker.points.push_back(marker_pos);
 
-      double ratio = computeRatio(
-          config.esdf_min_distance, config.esdf_max_distance, voxel.distance);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
-
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.esdf_alpha);
-      marker.colors.push_back(color_msg);
+      ratios.push_back(computeRatio(
+          config.esdf_min_distance, config.esdf_max_distance, voxel.distance));
     }
   }
 
+  dsg_utils::getColormapLut(colors).colorAll(ratios, config.esdf_alpha, marker.colors);
+
   return marker;
 }
 
@@ -403,7 +399,7 @@ Marker makeBlocksMarker(const GvdLayer& layer, double scale) {
 }
 
 std_msgs::ColorRGBA makeGvdColor(const GvdVisualizerConfig& config,
-                                 const ColormapConfig& colors,
+                                 const dsg_utils::ColormapLut& colormap,
                                  double distance,
                                  uint8_t num_basis_points) {
   double ratio;
@@ -424,8 +420,7 @@ std_msgs::ColorRGBA makeGvdColor(const GvdVisualizerConfig& config,
       break;
   }
 
-  Color color = dsg_utils::interpolateColorMap(colors, ratio);
-  return dsg_utils::makeColorMsg(color, alpha);
+  return colormap.getColorMsg(ratio, alpha);
 }
 
 using EdgeMap = std::unordered_map<uint64_t, std::unordered_set<uint64_t>>;
@@ -479,13 +474,14 @@ MarkerArray makeGvdGraphMarkers(const GvdGraph& graph,
   auto& nodes = marker.markers[0];
   auto& edges = marker.markers[1];
 
+  const auto& colormap = dsg_utils::getColormapLut(colors);
   EdgeMap seen_edges;
   for (const auto& id_node_pair : graph.nodes()) {
     geometry_msgs::Point node_centroid;
     tf2::convert(id_node_pair.second.position, node_centroid);
     nodes.points.push_back(node_centroid);
     nodes.colors.push_back(makeGvdColor(config,
-                                        colors,
+                                        colormap,
                                         id_node_pair.second.distance,
                                         id_node_pair.second.num_basis_points));
 
@@ -506,7 +502,7 @@ MarkerArray makeGvdGraphMarkers(const GvdGraph& graph,
       tf2::convert(other.position, neighbor_centroid);
       edges.points.push_back(neighbor_centroid);
       edges.colors.push_back(
-          makeGvdColor(config, colors, other.distance, other.num_basis_points));
+          makeGvdColor(config, colormap, other.distance, other.num_basis_points));
     }
   }
 
@@ -42,6 +42,8 @@
 #include <glog/logging.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include <thread>
+
 namespace hydra {
 
 void declare_config(HydraVisualizerConfig& config) {
@@ -54,6 +56,7 @@ void declare_config(HydraVisualizerConfig& config) {
   field(config.output_path, "output_path");
   field(config.zmq_url, "zmq_url");
   field(config.zmq_num_threads, "zmq_num_threads");
+  field(config.republish_period_s, "republish_period_s", "s");
   field(config.plugins, "plugins");
 }
 
@@ -105,42 +108,90 @@ bool HydraVisualizer::handleReload(std_srvs::Empty::Request&,
 
 bool HydraVisualizer::handleRedraw(std_srvs::Empty::Request&,
                                    std_srvs::Empty::Response&) {
-  // TODO(nathan) this is technically safe, but not super ideal
+  // the redraw itself happens on whichever thread owns drawing
   visualizer_->setGraphUpdated();
-  visualizer_->redraw();
   return true;
 }
 
+void HydraVisualizer::republishLoop(const ros::WallTimerEvent&) {
+  visualizer_->republishCached();
+}
+
 void HydraVisualizer::spinRos() {
-  receiver_.reset(new DsgReceiver(nh_, [&](const ros::Time& stamp, size_t bytes) {
+  // graph updates get their own queue so parsing never waits on configs or drawing
+  ros::CallbackQueue receive_queue;
+  ros::NodeHandle receive_nh(nh_);
+  receive_nh.setCallbackQueue(&receive_queue);
+  const auto log_size = [&](const ros::Time& stamp, size_t bytes) {
     if (size_log_file_) {
       *size_log_file_ << stamp.toNSec() << "," << bytes << std::endl;
     }
-  }));
+  };
+  receiver_.reset(new DsgReceiver(receive_nh, log_size));
 
-  bool graph_set = false;
+  std::thread receive_thread(&HydraVisualizer::receiveLoop, this, &receive_queue);
+
+  // configs and services share the drawing thread so that dynamic_reconfigure never
+  // writes a config (or has its server replaced) while markers are being drawn
+  drawLoop();
+
+  graph_cv_.notify_all();
+  receive_thread.join();
+}
 
-  ros::WallRate r(10);
+void HydraVisualizer::receiveLoop(ros::CallbackQueue* queue) {
+  bool pending = false;
   while (ros::ok()) {
-    ros::spinOnce();
+    queue->callAvailable(ros::WallDuration(0.1));
+    if (receiver_->updated() && receiver_->graph()) {
+      receiver_->clearUpdated();
+      pending = true;
+    }
+
+    if (!pending) {
+      continue;
+    }
 
-    if (receiver_ && receiver_->updated()) {
-      if (!receiver_->graph()) {
-        r.sleep();
+    {  // scope for lock
+      std::lock_guard<std::mutex> lock(graph_mutex_);
+      if (!graph_requested_) {
+        // still drawing: only the newest graph gets copied once drawing finishes
         continue;
       }
-      if (!graph_set) {
-        visualizer_->setGraph(receiver_->graph());
-        graph_set = true;
-      } else {
-        visualizer_->setGraphUpdated();
-      }
 
-      visualizer_->redraw();
-      receiver_->clearUpdated();
+      // the receiver updates its graph in place, so drawing needs its own copy
+      latest_graph_ = receiver_->graph()->clone();
+      graph_requested_ = false;
     }
 
-    r.sleep();
+    pending = false;
+    graph_cv_.notify_one();
+  }
+}
+
+void HydraVisualizer::drawLoop() {
+  auto& callbacks = *ros::getGlobalCallbackQueue();
+  bool graph_set = false;
+  while (ros::ok()) {
+    callbacks.callAvailable();
+
+    DynamicSceneGraph::Ptr graph;
+    {  // scope for lock
+      std::unique_lock<std::mutex> lock(graph_mutex_);
+      graph_requested_ = true;
+      // wake up regularly to pick up config changes and redraw requests
+      graph_cv_.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+        return latest_graph_ != nullptr || !ros::ok();
+      });
+      graph.swap(latest_graph_);
+    }
+
+    if (graph) {
+      visualizer_->setGraph(graph, !graph_set);
+      graph_set = true;
+    }
+
+    visualizer_->redraw();
   }
 }
 
@@ -154,16 +205,15 @@ void HydraVisualizer::spinFile() {
 
   reload_service_ =
       nh_.advertiseService("reload", &HydraVisualizer::handleReload, this);
+  // the display loop only redraws when the configs, plugins or graph change
   visualizer_->start();
-
-  // Still publish updates if they need to be e.g. redrawn.
-  ros::WallRate r(5);
-  while (ros::ok()) {
-    ros::spinOnce();
-    visualizer_->setGraphUpdated();
-    visualizer_->redraw();
-    r.sleep();
+  if (config_.republish_period_s > 0.0) {
+    const ros::WallDuration period(config_.republish_period_s);
+    republish_timer_ =
+        nh_.createWallTimer(period, &HydraVisualizer::republishLoop, this);
   }
+
+  ros::spin();
 }
 
 void HydraVisualizer::spinZmq() {
@@ -175,22 +225,19 @@ void HydraVisualizer::spinZmq() {
     ros::spinOnce();
 
     // we always receive all messages
-    if (!zmq_receiver_->recv(config_.zmq_poll_time_ms, true)) {
-      continue;
-    }
-
-    auto graph = zmq_receiver_->graph();
-    if (!graph) {
-      continue;
-    }
-
-    if (!graph_set) {
-      visualizer_->setGraph(graph);
-      graph_set = true;
-    } else {
-      visualizer_->setGraphUpdated();
+    auto graph = zmq_receiver_->recv(config_.zmq_poll_time_ms, true)
+                     ? zmq_receiver_->graph()
+                     : nullptr;
+    if (graph) {
+      if (!graph_set) {
+        visualizer_->setGraph(graph);
+        graph_set = true;
+      } else {
+        visualizer_->setGraphUpdated();
+      }
     }
 
+    // also picks up redraw requests and config changes between graphs
     visualizer_->redraw();
   }
 }
@@ -8,6 +8,54 @@ namespace hydra {
 using spark_dsg::Color;
 using spark_dsg::Mesh;
 
+namespace {
+
+//! colorFromTime with the ironbow colormap sampled into a table
+class TimeColors {
+ public:
+  TimeColors(Mesh::Timestamp min, Mesh::Timestamp max)
+      : min_(min), max_(max), scale_(0.0), colors_(1024) {
+    if (max_ > min_) {
+      scale_ = (colors_.size() - 1) / static_cast<double>(max_ - min_);
+    }
+
+    for (size_t i = 0; i < colors_.size(); ++i) {
+      colors_[i] = Color::ironbow(static_cast<double>(i) / (colors_.size() - 1));
+    }
+  }
+
+  Color operator()(Mesh::Timestamp time) const {
+    if (time == 0) {
+      return Color::green();
+    }
+    if (time <= min_) {
+      return colors_.front();
+    } else if (time >= max_) {
+      return colors_.back();
+    }
+    return colors_[static_cast<size_t>((time - min_) * scale_ + 0.5)];
+  }
+
+ private:
+  const Mesh::Timestamp min_;
+  const Mesh::Timestamp max_;
+  double scale_;
+  std::vector<Color> colors_;
+};
+
+}  // namespace
+
+void MeshColoring::colorAll(const Mesh& mesh, std::vector<Color>& colors) const {
+  colors.resize(mesh.numVertices());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = getVertexColor(mesh, i);
+  }
+}
+
+void UniformMeshColoring::colorAll(const Mesh& mesh, std::vector<Color>& colors) const {
+  colors.assign(mesh.numVertices(), color_);
+}
+
 FirstSeenMeshColoring::FirstSeenMeshColoring(const Mesh& mesh) {
   min_ = std::numeric_limits<Mesh::Timestamp>::max();
   max_ = std::numeric_limits<Mesh::Timestamp>::min();
@@ -28,6 +76,15 @@ Color FirstSeenMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colorFromTime(mesh.first_seen_stamps[i], min_, max_);
 }
 
+void FirstSeenMeshColoring::colorAll(const Mesh& mesh,
+                                     std::vector<Color>& colors) const {
+  const TimeColors time_colors(min_, max_);
+  colors.resize(mesh.numVertices());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = time_colors(mesh.first_seen_stamps[i]);
+  }
+}
+
 LastSeenMeshColoring::LastSeenMeshColoring(Mesh::Timestamp min, Mesh::Timestamp max)
     : min_(min), max_(max) {}
 
@@ -48,6 +105,15 @@ Color LastSeenMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colorFromTime(mesh.stamps[i], min_, max_);
 }
 
+void LastSeenMeshColoring::colorAll(const Mesh& mesh,
+                                    std::vector<Color>& colors) const {
+  const TimeColors time_colors(min_, max_);
+  colors.resize(mesh.numVertices());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = time_colors(mesh.stamps[i]);
+  }
+}
+
 SeenDurationMeshColoring::SeenDurationMeshColoring(Mesh::Timestamp max) : max_(max) {}
 
 SeenDurationMeshColoring::SeenDurationMeshColoring(const Mesh& mesh) {
@@ -64,6 +130,15 @@ Color SeenDurationMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const
   return colorFromTime(mesh.stamps[i] - mesh.first_seen_stamps[i], 0, max_);
 }
 
+void SeenDurationMeshColoring::colorAll(const Mesh& mesh,
+                                        std::vector<Color>& colors) const {
+  const TimeColors time_colors(0, max_);
+  colors.resize(mesh.numVertices());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    colors[i] = time_colors(mesh.stamps[i] - mesh.first_seen_stamps[i]);
+  }
+}
+
 SemanticMeshColoring::SemanticMeshColoring(const SemanticColorMap& colormap)
     : colormap_(colormap) {}
 
@@ -79,14 +154,31 @@ Color SemanticMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colormap_.getColorFromLabel(label);
 }
 
+void SemanticMeshColoring::colorAll(const Mesh& mesh,
+                                    std::vector<Color>& colors) const {
+  if (!mesh.has_labels) {
+    colors.assign(mesh.numVertices(), Color::black());
+    return;
+  }
+
+  // flat table so each vertex is a single lookup instead of a colormap query
+  std::vector<Color> label_colors(colormap_.getNumLabels());
+  for (size_t label = 0; label < label_colors.size(); ++label) {
+    label_colors[label] = colormap_.getColorFromLabel(label);
+  }
+
+  const auto unknown = Color::gray(0.5);
+  colors.resize(mesh.numVertices());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    const size_t label = mesh.label(i);
+    colors[i] = label < label_colors.size() ? label_colors[label] : unknown;
+  }
+}
+
 MeshColorAdaptor::MeshColorAdaptor(const Mesh& mesh, MeshColoring::ConstPtr coloring)
     : mesh(mesh), coloring_(std::move(coloring)) {
   if (coloring_) {
-    getVertexColor = [this](size_t i) {
-      return coloring_->getVertexColor(this->mesh, i);
-    };
-  } else {
-    getVertexColor = [this](size_t i) { return this->mesh.color(i); };
+    coloring_->colorAll(mesh, colors_);
   }
 }
 
@@ -70,7 +70,7 @@ MeshPlugin::MeshPlugin(const Config& config,
   }
 
   // namespacing gives us a reasonable topic
-  mesh_pub_ = nh_.advertise<kimera_pgmo_msgs::KimeraPgmoMesh>("", 1, true);
+  mesh_pub_ = advertise<kimera_pgmo_msgs::KimeraPgmoMesh>("", 1);
 }
 
 MeshPlugin::~MeshPlugin() {}
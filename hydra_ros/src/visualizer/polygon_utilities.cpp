@@ -56,9 +56,6 @@ double getMeanNeighborHeight(const SceneGraphLayer& graph,
                              const SceneGraphNode& node,
                              double neighborhood_size,
                              bool use_nearest_node_finder) {
-  double total = 0.0;
-  size_t num_found = 0;
-
   if (use_nearest_node_finder) {
     std::vector<NodeId> node_ids;
     for (const auto& id_node_pair : graph.nodes()) {
@@ -66,33 +63,76 @@ double getMeanNeighborHeight(const SceneGraphLayer& graph,
     }
 
     NearestNodeFinder finder(graph, node_ids);
-    num_found = finder.findRadius(node.attributes().position,
-                                  neighborhood_size,
-                                  false,
-                                  [&](NodeId neighbor_id, size_t, double) {
-                                    total += graph.getPosition(neighbor_id).z();
-                                  });
-  } else {
-    std::deque<NodeId> frontier{node.id};
-    std::unordered_set<NodeId> visited{node.id};
-    graph_utilities::breadthFirstSearch(
-        graph,
-        frontier,
-        visited,
-        [&](const auto& other) {
-          return (node.attributes().position - other.attributes().position).norm() <
-                 neighborhood_size;
-        },
-        [](const auto&) { return true; },
-        [&](const SceneGraphLayer&, NodeId other) {
-          total += graph.getPosition(other).z();
-          ++num_found;
-        });
+    return getMeanNeighborHeight(graph, finder, node, neighborhood_size);
   }
 
+  double total = 0.0;
+  size_t num_found = 0;
+  std::deque<NodeId> frontier{node.id};
+  std::unordered_set<NodeId> visited{node.id};
+  graph_utilities::breadthFirstSearch(
+      graph,
+      frontier,
+      visited,
+      [&](const auto& other) {
+        return (node.attributes().position - other.attributes().position).norm() <
+               neighborhood_size;
+      },
+      [](const auto&) { return true; },
+      [&](const SceneGraphLayer&, NodeId other) {
+        total += graph.getPosition(other).z();
+        ++num_found;
+      });
+
   return num_found ? total / static_cast<double>(num_found) : 0.0;
 }
 
+double getMeanNeighborHeight(const SceneGraphLayer& graph,
+                             NearestNodeFinder& finder,
+                             const SceneGraphNode& node,
+                             double neighborhood_size) {
+  double total = 0.0;
+  const auto add_height = [&](NodeId neighbor_id, size_t, double) {
+    total += graph.getPosition(neighbor_id).z();
+  };
+
+  const auto& pos = node.attributes().position;
+  const size_t num_found = finder.findRadius(pos, neighborhood_size, false, add_height);
+  return num_found ? total / static_cast<double>(num_found) : 0.0;
+}
+
+std::unordered_map<NodeId, double> getMeanNeighborHeights(
+    const SceneGraphLayer& graph,
+    double neighborhood_size,
+    bool use_nearest_node_finder) {
+  std::unordered_map<NodeId, double> heights;
+  if (graph.numNodes() == 0) {
+    return heights;
+  }
+
+  heights.reserve(graph.numNodes());
+  if (!use_nearest_node_finder) {
+    for (const auto& [node_id, node] : graph.nodes()) {
+      heights[node_id] = getMeanNeighborHeight(graph, *node, neighborhood_size, false);
+    }
+
+    return heights;
+  }
+
+  std::vector<NodeId> node_ids;
+  node_ids.reserve(graph.numNodes());
+  for (const auto& id_node_pair : graph.nodes()) {
+    node_ids.push_back(id_node_pair.first);
+  }
+
+  NearestNodeFinder finder(graph, node_ids);
+  for (const auto& [node_id, node] : graph.nodes()) {
+    heights[node_id] = getMeanNeighborHeight(graph, finder, *node, neighborhood_size);
+  }
+
+  return heights;
+}
+
 Eigen::MatrixXd getCirclePolygon(const SceneGraphNode& node,
                                  double radius,
                                  size_t num_samples) {
@@ -142,19 +182,50 @@ Eigen::MatrixXd getChildrenConvexHull(const DynamicSceneGraph& graph,
   return hull_points;
 }
 
-void makeFilledPolygon(const Eigen::MatrixXd& points,
-                       const std_msgs::ColorRGBA& color,
-                       visualization_msgs::Marker& marker,
-                       std::optional<double> height) {
-  if (points.cols() <= 1 || points.rows() != 3) {
-    LOG(ERROR) << "Invalid point dimensions: [" << points.rows() << ", "
-               << points.cols() << "]";
-    return;
+const CachedPolygon& PolygonCache::get(NodeId node,
+                                       size_t fingerprint,
+                                       const PolygonFunction& make_polygon) {
+  seen_.insert(node);
+  auto iter = polygons_.find(node);
+  if (iter != polygons_.end() && iter->second.fingerprint == fingerprint) {
+    return iter->second;
   }
 
-  auto polygon = Polygon::fromPoints(points);
-  const auto faces = polygon.triangulate();
+  auto& polygon = polygons_[node];
+  polygon = CachedPolygon();
+  polygon.fingerprint = fingerprint;
+  make_polygon(polygon);
+  if (polygon.points.cols() > 1 && polygon.points.rows() == 3) {
+    polygon.faces = Polygon::fromPoints(polygon.points).triangulate();
+  }
+
+  return polygon;
+}
+
+void PolygonCache::prune() {
+  for (auto iter = polygons_.begin(); iter != polygons_.end();) {
+    if (seen_.count(iter->first)) {
+      ++iter;
+    } else {
+      iter = polygons_.erase(iter);
+    }
+  }
+
+  seen_.clear();
+}
+
+void PolygonCache::clear() {
+  polygons_.clear();
+  seen_.clear();
+}
 
+void addTriangles(const Eigen::MatrixXd& points,
+                  const std::vector<std::array<size_t, 3>>& faces,
+                  const std_msgs::ColorRGBA& color,
+                  visualization_msgs::Marker& marker,
+                  std::optional<double> height) {
+  // polygons are appended into shared markers, so an exact reserve per polygon would
+  // defeat geometric growth and copy every earlier point again
   for (const auto& face : faces) {
     for (const auto idx : face) {
       auto& point = marker.points.emplace_back();
@@ -167,6 +238,27 @@ void makeFilledPolygon(const Eigen::MatrixXd& points,
   }
 }
 
+void addFilledPolygon(const CachedPolygon& polygon,
+                      const std_msgs::ColorRGBA& color,
+                      visualization_msgs::Marker& marker,
+                      std::optional<double> height) {
+  addTriangles(polygon.points, polygon.faces, color, marker, height);
+}
+
+void makeFilledPolygon(const Eigen::MatrixXd& points,
+                       const std_msgs::ColorRGBA& color,
+                       visualization_msgs::Marker& marker,
+                       std::optional<double> height) {
+  if (points.cols() <= 1 || points.rows() != 3) {
+    LOG(ERROR) << "Invalid point dimensions: [" << points.rows() << ", "
+               << points.cols() << "]";
+    return;
+  }
+
+  auto polygon = Polygon::fromPoints(points);
+  addTriangles(points, polygon.triangulate(), color, marker, height);
+}
+
 void makePolygonBoundary(const Eigen::MatrixXd& points,
                          const std_msgs::ColorRGBA& color,
                          visualization_msgs::Marker& edges,
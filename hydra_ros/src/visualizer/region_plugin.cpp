@@ -66,7 +66,7 @@ RegionPlugin::RegionPlugin(const Config& config,
                            const std::string& name)
     : DsgVisualizerPlugin(nh, name), config(config::checkValid(config)) {
   // namespacing gives us a reasonable topic
-  pub_ = nh_.advertise<visualization_msgs::MarkerArray>("", 1, true);
+  pub_ = advertise<visualization_msgs::MarkerArray>("", 1);
 }
 
 RegionPlugin::~RegionPlugin() {}
@@ -117,8 +117,17 @@ void RegionPlugin::draw(const ConfigManager&,
     auto color = dsg_utils::makeColorMsg(attrs.color);
     color.a = config.line_alpha;
 
-    const double mean_z = getMeanChildHeight(graph, *node);
-    auto hull_points = getChildrenConvexHull(graph, *node);
+    size_t fingerprint = 0;
+    for (const auto child : node->children()) {
+      hashCombine(fingerprint, child);
+      hashPosition(fingerprint, graph.getPosition(child));
+    }
+
+    const auto& hull = polygons_.get(id, fingerprint, [&](CachedPolygon& polygon) {
+      polygon.points = getChildrenConvexHull(graph, *node);
+      polygon.height = getMeanChildHeight(graph, *node);
+    });
+    const double mean_z = hull.height.value_or(0.0);
 
     if (config.draw_labels) {
       const auto& pos = attrs.position;
@@ -140,10 +149,11 @@ void RegionPlugin::draw(const ConfigManager&,
 
     auto mesh_color = color;
     mesh_color.a = config.mesh_alpha;
-    makeFilledPolygon(hull_points, mesh_color, msg.markers[0], mean_z);
-    makePolygonBoundary(hull_points, color, msg.markers[1], mean_z, &msg.markers[2]);
+    addFilledPolygon(hull, mesh_color, msg.markers[0], mean_z);
+    makePolygonBoundary(hull.points, color, msg.markers[1], mean_z, &msg.markers[2]);
   }
 
+  polygons_.prune();
   pub_.publish(msg);
 }
 
@@ -157,6 +167,7 @@ void RegionPlugin::reset(const std_msgs::Header& header, const DynamicSceneGraph
     msg.markers.push_back(makeDeleteMarker(header, id, "region_plugin_labels"));
   }
   published_labels_.clear();
+  polygons_.clear();
   pub_.publish(msg);
 }
 
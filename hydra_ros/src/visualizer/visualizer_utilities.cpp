@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/visualizer/visualizer_utilities.h"
 
+#include <sensor_msgs/point_cloud2_iterator.h>
 #include <spark_dsg/node_attributes.h>
 #include <tf2_eigen/tf2_eigen.h>
 
@@ -57,6 +58,21 @@ using visualization_msgs::MarkerArray;
 
 namespace {
 
+inline void reserveMarker(Marker& marker,
+                          size_t num_points,
+                          MarkerBuffers* buffers,
+                          bool use_colors = true) {
+  if (buffers) {
+    buffers->reserve(marker, num_points, use_colors);
+    return;
+  }
+
+  marker.points.reserve(num_points);
+  if (use_colors) {
+    marker.colors.reserve(num_points);
+  }
+}
+
 inline double getRatio(double min, double max, double value) {
   double ratio = (value - min) / (max - min);
   ratio = !std::isfinite(ratio) ? 0.0 : ratio;
@@ -73,9 +89,50 @@ inline void fillPoseWithIdentity(geometry_msgs::Pose& pose) {
 
 }  // namespace
 
+void MarkerBuffers::reserve(Marker& marker, size_t num_points, bool use_colors) {
+  {  // scope for lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = buffers_.find(marker.ns);
+    if (iter != buffers_.end()) {
+      marker.points = std::move(iter->second.points);
+      marker.colors = std::move(iter->second.colors);
+      buffers_.erase(iter);
+    }
+  }
+
+  marker.points.clear();
+  marker.colors.clear();
+  marker.points.reserve(num_points);
+  if (use_colors) {
+    marker.colors.reserve(num_points);
+  }
+}
+
+void MarkerBuffers::release(MarkerArray& msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& marker : msg.markers) {
+    if (marker.points.capacity() == 0) {
+      continue;
+    }
+
+    auto& buffer = buffers_[marker.ns];
+    if (buffer.points.capacity() >= marker.points.capacity()) {
+      continue;
+    }
+
+    buffer.points = std::move(marker.points);
+    buffer.colors = std::move(marker.colors);
+  }
+}
+
+void MarkerBuffers::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_.clear();
+}
+
 Color getDistanceColor(const VisualizerConfig& config,
-                           const ColormapConfig& colors,
-                           double distance) {
+                       const dsg_utils::ColormapLut& colormap,
+                       double distance) {
   if (config.places_colormap_max_distance <= config.places_colormap_min_distance) {
     // TODO(nathan) consider warning
     return Color();
@@ -85,7 +142,7 @@ Color getDistanceColor(const VisualizerConfig& config,
                           config.places_colormap_max_distance,
                           distance);
 
-  return dsg_utils::interpolateColorMap(colors, ratio);
+  return colormap(ratio);
 }
 
 Marker makeDeleteMarker(const std_msgs::Header& header,
@@ -573,7 +630,8 @@ Marker makeCentroidMarkers(const std_msgs::Header& header,
                            const VisualizerConfig& visualizer_config,
                            const std::string& ns,
                            const ColorFunction& color_func,
-                           const FilterFunction& filter) {
+                           const FilterFunction& filter,
+                           MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = config.use_sphere_marker ? Marker::SPHERE_LIST : Marker::CUBE_LIST;
@@ -587,8 +645,7 @@ Marker makeCentroidMarkers(const std_msgs::Header& header,
 
   fillPoseWithIdentity(marker.pose);
 
-  marker.points.reserve(layer.numNodes());
-  marker.colors.reserve(layer.numNodes());
+  reserveMarker(marker, layer.numNodes(), buffers);
   for (const auto& id_node_pair : layer.nodes()) {
     if (filter && !filter(*id_node_pair.second)) {
       continue;
@@ -606,12 +663,59 @@ Marker makeCentroidMarkers(const std_msgs::Header& header,
   return marker;
 }
 
+sensor_msgs::PointCloud2 makeCentroidCloud(const std_msgs::Header& header,
+                                           const LayerConfig& config,
+                                           const SceneGraphLayer& layer,
+                                           const VisualizerConfig& visualizer_config,
+                                           const ColorFunction& color_func,
+                                           const FilterFunction& filter) {
+  sensor_msgs::PointCloud2 cloud;
+  cloud.header = header;
+  cloud.height = 1;
+  cloud.is_dense = true;
+
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+  modifier.resize(layer.numNodes());
+
+  sensor_msgs::PointCloud2Iterator<float> iter_xyz(cloud, "x");
+  sensor_msgs::PointCloud2Iterator<uint8_t> iter_rgb(cloud, "rgb");
+  const double z_offset = getZOffset(config, visualizer_config);
+  size_t num_points = 0;
+  for (const auto& id_node_pair : layer.nodes()) {
+    const auto& node = *id_node_pair.second;
+    if (filter && !filter(node)) {
+      continue;
+    }
+
+    const auto& pos = node.attributes().position;
+    iter_xyz[0] = static_cast<float>(pos.x());
+    iter_xyz[1] = static_cast<float>(pos.y());
+    iter_xyz[2] = static_cast<float>(pos.z() + z_offset);
+
+    // packed rgb is stored little-endian as bgr
+    const auto color = color_func(node);
+    iter_rgb[0] = color.b;
+    iter_rgb[1] = color.g;
+    iter_rgb[2] = color.r;
+
+    ++iter_xyz;
+    ++iter_rgb;
+    ++num_points;
+  }
+
+  modifier.resize(num_points);
+  return cloud;
+}
+
 Marker makePlaceCentroidMarkers(const std_msgs::Header& header,
                                 const LayerConfig& config,
                                 const SceneGraphLayer& layer,
                                 const VisualizerConfig& visualizer_config,
                                 const std::string& ns,
-                                const ColorFunction& color_func) {
+                                const ColorFunction& color_func,
+                                const FilterFunction& filter,
+                                MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = config.use_sphere_marker ? Marker::SPHERE_LIST : Marker::CUBE_LIST;
@@ -625,13 +729,17 @@ Marker makePlaceCentroidMarkers(const std_msgs::Header& header,
 
   fillPoseWithIdentity(marker.pose);
 
-  marker.points.reserve(layer.numNodes());
-  marker.colors.reserve(layer.numNodes());
+  reserveMarker(marker, layer.numNodes(), buffers);
   for (const auto& id_node_pair : layer.nodes()) {
     const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
     if (!attrs.real_place) {
       continue;
     }
+
+    if (filter && !filter(*id_node_pair.second)) {
+      continue;
+    }
+
     geometry_msgs::Point node_centroid;
     tf2::convert(attrs.position, node_centroid);
     node_centroid.z += getZOffset(config, visualizer_config);
@@ -693,7 +801,8 @@ MarkerArray makeDynamicGraphEdgeMarkers(
     const std::map<LayerId, LayerConfig>& configs,
     const std::map<LayerId, DynamicLayerConfig>& dynamic_configs,
     const VisualizerConfig& visualizer_config,
-    const std::string& ns_prefix) {
+    const std::string& ns_prefix,
+    MarkerBuffers* buffers) {
   MarkerArray layer_edges;
   std::map<LayerId, Marker> layer_markers;
   std::map<LayerId, size_t> num_since_last_insertion;
@@ -720,6 +829,7 @@ MarkerArray makeDynamicGraphEdgeMarkers(
           header, configs.at(source.layer), ns_prefix, source.layer, target.layer);
       layer_markers[source.layer].color =
           makeColorMsg(Color(), config.edge_alpha);
+      reserveMarker(layer_markers[source.layer], 0, buffers, false);
       // make sure we always draw at least one edge
       num_since_last_insertion[source.layer] = num_between_insertions;
     }
@@ -743,8 +853,8 @@ MarkerArray makeDynamicGraphEdgeMarkers(
     marker.points.push_back(target_point);
   }
 
-  for (const auto& id_marker_pair : layer_markers) {
-    layer_edges.markers.push_back(id_marker_pair.second);
+  for (auto& id_marker_pair : layer_markers) {
+    layer_edges.markers.push_back(std::move(id_marker_pair.second));
   }
   return layer_edges;
 }
@@ -755,7 +865,8 @@ MarkerArray makeGraphEdgeMarkers(const std_msgs::Header& header,
                                  const std::map<LayerId, LayerConfig>& configs,
                                  const VisualizerConfig& visualizer_config,
                                  const std::string& ns_prefix,
-                                 const FilterFunction& filter) {
+                                 const FilterFunction& filter,
+                                 MarkerBuffers* buffers) {
   MarkerArray layer_edges;
   std::map<LayerId, Marker> layer_markers;
   std::map<LayerId, size_t> num_since_last_insertion;
@@ -792,6 +903,8 @@ MarkerArray makeGraphEdgeMarkers(const std_msgs::Header& header,
     if (layer_markers.count(source.layer) == 0) {
       layer_markers[source.layer] = makeNewEdgeList(
           header, configs.at(source.layer), ns_prefix, source.layer, target.layer);
+      // counts per layer pair aren't known up front, so rely on the previous capacity
+      reserveMarker(layer_markers[source.layer], 0, buffers);
       // make sure we always draw at least one edge
       num_since_last_insertion[source.layer] = num_between_insertions;
     }
@@ -833,8 +946,8 @@ MarkerArray makeGraphEdgeMarkers(const std_msgs::Header& header,
         makeColorMsg(edge_color, configs.at(source.layer).intralayer_edge_alpha));
   }
 
-  for (const auto& id_marker_pair : layer_markers) {
-    layer_edges.markers.push_back(id_marker_pair.second);
+  for (auto& id_marker_pair : layer_markers) {
+    layer_edges.markers.push_back(std::move(id_marker_pair.second));
   }
   return layer_edges;
 }
@@ -844,7 +957,8 @@ Marker makeMeshEdgesMarker(const std_msgs::Header& header,
                            const VisualizerConfig& visualizer_config,
                            const DynamicSceneGraph& graph,
                            const SceneGraphLayer& layer,
-                           const std::string& ns) {
+                           const std::string& ns,
+                           MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = Marker::LINE_LIST;
@@ -860,6 +974,17 @@ Marker makeMeshEdgesMarker(const std_msgs::Header& header,
     return marker;
   }
 
+  const size_t stride = config.interlayer_edge_insertion_skip + 1;
+  size_t num_points = 0;
+  for (const auto& id_node_pair : layer.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes<Place2dNodeAttributes>();
+    const auto num_connections = attrs.pcl_mesh_connections.size();
+    if (num_connections) {
+      num_points += 2 * (1 + (num_connections + stride - 1) / stride);
+    }
+  }
+
+  reserveMarker(marker, num_points, buffers);
   for (const auto& id_node_pair : layer.nodes()) {
     const auto& node = *id_node_pair.second;
     const auto& attrs = node.attributes<Place2dNodeAttributes>();
@@ -935,14 +1060,15 @@ MarkerArray makeGvdWireframe(const std_msgs::Header& header,
                              const std::string& ns,
                              const ColormapConfig& colors,
                              size_t marker_id) {
+  const auto& colormap = dsg_utils::getColormapLut(colors);
   return makeGvdWireframe(
       header,
       config,
       layer,
       ns,
       [&](const SceneGraphNode& node) {
-        return getDistanceColor(
-            visualizer_config, colors, node.attributes<PlaceNodeAttributes>().distance);
+        const auto& attrs = node.attributes<PlaceNodeAttributes>();
+        return getDistanceColor(visualizer_config, colormap, attrs.distance);
       },
       marker_id);
 }
@@ -1021,13 +1147,64 @@ MarkerArray makeGvdWireframe(const std_msgs::Header& header,
   return marker;
 }
 
+Marker makeCompactLayerEdgeMarkers(const std_msgs::Header& header,
+                                   const LayerConfig& config,
+                                   const SceneGraphLayer& layer,
+                                   const VisualizerConfig& visualizer_config,
+                                   const Color& color,
+                                   const std::string& ns,
+                                   const FilterFunction& filter,
+                                   MarkerBuffers* buffers) {
+  Marker marker;
+  marker.header = header;
+  marker.type = Marker::LINE_LIST;
+  marker.id = 0;
+  marker.ns = ns;
+
+  marker.action = Marker::ADD;
+  marker.scale.x = config.intralayer_edge_scale;
+  marker.color = makeColorMsg(color, config.intralayer_edge_alpha);
+  fillPoseWithIdentity(marker.pose);
+
+  const size_t stride = config.intralayer_edge_insertion_skip + 1;
+  const auto num_points = 2 * ((layer.numEdges() + stride - 1) / stride);
+  reserveMarker(marker, num_points, buffers, false);
+  const double z_offset = getZOffset(config, visualizer_config);
+  size_t edge_index = 0;
+  for (const auto& id_edge_pair : layer.edges()) {
+    const auto& edge = id_edge_pair.second;
+    if (edge_index++ % stride != 0) {
+      continue;
+    }
+
+    const auto& source_node = layer.getNode(edge.source);
+    const auto& target_node = layer.getNode(edge.target);
+    if (filter && (!filter(source_node) || !filter(target_node))) {
+      continue;
+    }
+
+    geometry_msgs::Point source;
+    tf2::convert(source_node.attributes().position, source);
+    source.z += z_offset;
+    marker.points.push_back(source);
+
+    geometry_msgs::Point target;
+    tf2::convert(target_node.attributes().position, target);
+    target.z += z_offset;
+    marker.points.push_back(target);
+  }
+
+  return marker;
+}
+
 Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
                             const LayerConfig& config,
                             const SceneGraphLayer& layer,
                             const VisualizerConfig& visualizer_config,
                             const Color& color,
                             const std::string& ns,
-                            const FilterFunction& filter) {
+                            const FilterFunction& filter,
+                            MarkerBuffers* buffers) {
   return makeLayerEdgeMarkers(
       header,
       config,
@@ -1037,7 +1214,8 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
       [&](const SceneGraphNode&, const SceneGraphNode&, const SceneGraphEdge&, bool) {
         return color;
       },
-      filter);
+      filter,
+      buffers);
 }
 
 Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
@@ -1046,7 +1224,9 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
                             const VisualizerConfig& visualizer_config,
                             const ColormapConfig& cmap,
                             const std::string& ns,
-                            const FilterFunction& filter) {
+                            const FilterFunction& filter,
+                            MarkerBuffers* buffers) {
+  const auto& colormap = dsg_utils::getColormapLut(cmap);
   return makeLayerEdgeMarkers(
       header,
       config,
@@ -1057,9 +1237,10 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
           const SceneGraphNode&,
           const SceneGraphEdge& edge,
           bool) {
-        return getDistanceColor(visualizer_config, cmap, edge.attributes().weight);
+        return getDistanceColor(visualizer_config, colormap, edge.attributes().weight);
       },
-      filter);
+      filter,
+      buffers);
 }
 
 Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
@@ -1068,7 +1249,8 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
                             const VisualizerConfig& visualizer_config,
                             const std::string& ns,
                             const EdgeColorFunction& color_func,
-                            const FilterFunction& filter) {
+                            const FilterFunction& filter,
+                            MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = Marker::LINE_LIST;
@@ -1079,10 +1261,17 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
   marker.scale.x = config.intralayer_edge_scale;
   fillPoseWithIdentity(marker.pose);
 
-  auto edge_iter = layer.edges().begin();
-  while (edge_iter != layer.edges().end()) {
-    const auto& source_node = layer.getNode(edge_iter->second.source);
-    const auto& target_node = layer.getNode(edge_iter->second.target);
+  const size_t stride = config.intralayer_edge_insertion_skip + 1;
+  reserveMarker(marker, 2 * ((layer.numEdges() + stride - 1) / stride), buffers);
+  size_t edge_index = 0;
+  for (const auto& id_edge_pair : layer.edges()) {
+    const auto& edge = id_edge_pair.second;
+    if (edge_index++ % stride != 0) {
+      continue;
+    }
+
+    const auto& source_node = layer.getNode(edge.source);
+    const auto& target_node = layer.getNode(edge.target);
     if (filter && (!filter(source_node) || !filter(target_node))) {
       continue;
     }
@@ -1098,13 +1287,11 @@ Marker makeLayerEdgeMarkers(const std_msgs::Header& header,
     marker.points.push_back(target);
 
     marker.colors.push_back(
-        makeColorMsg(color_func(source_node, target_node, edge_iter->second, true),
+        makeColorMsg(color_func(source_node, target_node, edge, true),
                      config.intralayer_edge_alpha));
     marker.colors.push_back(
-        makeColorMsg(color_func(source_node, target_node, edge_iter->second, false),
+        makeColorMsg(color_func(source_node, target_node, edge, false),
                      config.intralayer_edge_alpha));
-
-    std::advance(edge_iter, config.intralayer_edge_insertion_skip + 1);
   }
 
   return marker;
@@ -1116,7 +1303,8 @@ Marker makeDynamicCentroidMarkers(const std_msgs::Header& header,
                                   const VisualizerConfig& visualizer_config,
                                   const Color& color,
                                   const std::string& ns,
-                                  size_t marker_id) {
+                                  size_t marker_id,
+                                  MarkerBuffers* buffers) {
   return makeDynamicCentroidMarkers(
       header,
       config,
@@ -1125,7 +1313,8 @@ Marker makeDynamicCentroidMarkers(const std_msgs::Header& header,
       visualizer_config,
       ns,
       [&](const auto&) -> Color { return color; },
-      marker_id);
+      marker_id,
+      buffers);
 }
 
 Marker makeDynamicCentroidMarkers(const std_msgs::Header& header,
@@ -1135,7 +1324,8 @@ Marker makeDynamicCentroidMarkers(const std_msgs::Header& header,
                                   const VisualizerConfig& visualizer_config,
                                   const std::string& ns,
                                   const ColorFunction& color_func,
-                                  size_t marker_id) {
+                                  size_t marker_id,
+                                  MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = config.node_use_sphere ? Marker::SPHERE_LIST : Marker::CUBE_LIST;
@@ -1149,7 +1339,7 @@ Marker makeDynamicCentroidMarkers(const std_msgs::Header& header,
 
   fillPoseWithIdentity(marker.pose);
 
-  marker.points.reserve(layer.numNodes());
+  reserveMarker(marker, layer.numNodes(), buffers);
   for (const auto& node : layer.nodes()) {
     if (!node) {
       continue;
@@ -1171,7 +1361,8 @@ Marker makeDynamicEdgeMarkers(const std_msgs::Header& header,
                               const VisualizerConfig& visualizer_config,
                               const Color& color,
                               const std::string& ns,
-                              size_t marker_id) {
+                              size_t marker_id,
+                              MarkerBuffers* buffers) {
   Marker marker;
   marker.header = header;
   marker.type = Marker::LINE_LIST;
@@ -1183,6 +1374,7 @@ Marker makeDynamicEdgeMarkers(const std_msgs::Header& header,
   marker.color = makeColorMsg(color, config.edge_alpha);
   fillPoseWithIdentity(marker.pose);
 
+  reserveMarker(marker, 2 * layer.numEdges(), buffers, false);
   for (const auto& id_edge_pair : layer.edges()) {
     geometry_msgs::Point source;
     tf2::convert(layer.getPosition(id_edge_pair.second.source), source);
@@ -0,0 +1,149 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/colormap_utilities.h>
+
+#include <limits>
+#include <thread>
+
+namespace hydra {
+
+using dsg_utils::ColormapLut;
+
+namespace {
+
+ColormapConfig makeColormap(double min_hue, double max_hue) {
+  ColormapConfig config;
+  config.min_hue = min_hue;
+  config.max_hue = max_hue;
+  config.min_saturation = 0.6;
+  config.max_saturation = 0.9;
+  config.min_luminance = 0.4;
+  config.max_luminance = 0.6;
+  return config;
+}
+
+void expectColorNear(const Color& lhs, const Color& rhs, int tolerance) {
+  EXPECT_NEAR(lhs.r, rhs.r, tolerance);
+  EXPECT_NEAR(lhs.g, rhs.g, tolerance);
+  EXPECT_NEAR(lhs.b, rhs.b, tolerance);
+  EXPECT_EQ(lhs.a, rhs.a);
+}
+
+}  // namespace
+
+TEST(ColormapLut, MatchesInterpolationAtEntries) {
+  const auto config = makeColormap(0.0, 0.8);
+  const ColormapLut lut(config, 64);
+  ASSERT_EQ(lut.size(), 64u);
+  for (size_t i = 0; i < lut.size(); ++i) {
+    SCOPED_TRACE("entry " + std::to_string(i));
+    const double ratio = static_cast<double>(i) / 63.0;
+    expectColorNear(lut(ratio), dsg_utils::interpolateColorMap(config, ratio), 0);
+  }
+}
+
+TEST(ColormapLut, MatchesInterpolationWithinQuantization) {
+  // a full hue sweep changes each channel by at most 6 * 255 per unit ratio, so
+  // rounding to the nearest of the 1024 entries is within a level or two
+  const auto config = makeColormap(0.0, 1.0);
+  const ColormapLut lut(config);
+  for (size_t i = 0; i <= 5000; ++i) {
+    SCOPED_TRACE("sample " + std::to_string(i));
+    const double ratio = static_cast<double>(i) / 5000.0;
+    expectColorNear(lut(ratio), dsg_utils::interpolateColorMap(config, ratio), 2);
+  }
+}
+
+TEST(ColormapLut, ClampsAndSetsAlpha) {
+  const auto config = makeColormap(0.2, 0.6);
+  const ColormapLut lut(config);
+  expectColorNear(lut(-1.0), dsg_utils::interpolateColorMap(config, 0.0), 0);
+  expectColorNear(lut(2.0), dsg_utils::interpolateColorMap(config, 1.0), 0);
+
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  expectColorNear(lut(nan), lut(0.0), 0);
+  expectColorNear(lut(std::numeric_limits<double>::infinity()), lut(0.0), 0);
+
+  const auto msg = lut.getColorMsg(0.5, 0.25);
+  const auto expected =
+      dsg_utils::makeColorMsg(dsg_utils::interpolateColorMap(config, 0.5), 0.25);
+  EXPECT_NEAR(msg.r, expected.r, 1.0 / 255.0);
+  EXPECT_NEAR(msg.g, expected.g, 1.0 / 255.0);
+  EXPECT_NEAR(msg.b, expected.b, 1.0 / 255.0);
+  EXPECT_EQ(msg.a, 0.25f);
+
+  std::vector<std_msgs::ColorRGBA> colors(1);
+  lut.colorAll({0.0, 0.5, 1.0}, 0.5, colors);
+  ASSERT_EQ(colors.size(), 4u);
+  EXPECT_EQ(colors[2].r, msg.r);
+  EXPECT_EQ(colors[3].a, 0.5f);
+}
+
+TEST(ColormapLut, CacheRebuildsChangedColormaps) {
+  const auto original = makeColormap(0.1, 0.3);
+  auto changed = original;
+  changed.max_luminance = 0.7;
+  EXPECT_TRUE(dsg_utils::getColormapLut(original).matches(original));
+  EXPECT_FALSE(dsg_utils::getColormapLut(original).matches(changed));
+  EXPECT_TRUE(dsg_utils::getColormapLut(changed).matches(changed));
+}
+
+TEST(ColormapLut, CacheEvictsOldestTable) {
+  // tables are cached per thread, so start from an empty cache
+  std::thread thread([]() {
+    std::vector<ColormapConfig> configs;
+    std::vector<const ColormapLut*> tables;
+    for (size_t i = 0; i < 9; ++i) {
+      configs.push_back(makeColormap(0.05 * i, 0.5 + 0.05 * i));
+      tables.push_back(&dsg_utils::getColormapLut(configs.back()));
+      EXPECT_TRUE(tables.back()->matches(configs.back()));
+    }
+
+    // the ninth colormap replaced the first, everything else is still cached
+    for (size_t i = 1; i < 9; ++i) {
+      EXPECT_EQ(&dsg_utils::getColormapLut(configs[i]), tables[i]);
+    }
+
+    // the evicted colormap gets rebuilt in the next slot
+    const auto& rebuilt = dsg_utils::getColormapLut(configs[0]);
+    EXPECT_TRUE(rebuilt.matches(configs[0]));
+    EXPECT_NE(&rebuilt, tables[8]);
+    EXPECT_TRUE(tables[8]->matches(configs[8]));
+  });
+  thread.join();
+}
+
+}  // namespace hydra
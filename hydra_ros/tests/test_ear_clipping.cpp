@@ -235,4 +235,39 @@ TEST(EarClipping, TriangulateMissingFaces) {
   EXPECT_EQ(faces, expected);
 }
 
+TEST(EarClipping, TriangulateLargeStar) {
+  // alternating radii make every other vertex reflex
+  const size_t num_vertices = 2000;
+  std::vector<Vertex> vertices;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const double theta = 2.0 * M_PI * i / num_vertices;
+    const double radius = i % 2 ? 0.5 : 1.0;
+    vertices.push_back(
+        {Eigen::Vector2d(radius * std::cos(theta), radius * std::sin(theta)), i});
+  }
+
+  Polygon polygon(vertices);
+  const auto faces = polygon.triangulate();
+  EXPECT_EQ(faces.size(), num_vertices - 2);
+
+  double total_area = 0.0;
+  for (const auto& face : faces) {
+    const Eigen::Vector2d v0 = vertices[face[0]].pos;
+    const Eigen::Vector2d e1 = vertices[face[1]].pos - v0;
+    const Eigen::Vector2d e2 = vertices[face[2]].pos - v0;
+    const double area = 0.5 * (e1.x() * e2.y() - e1.y() * e2.x());
+    EXPECT_GT(area, 0.0);
+    total_area += area;
+  }
+
+  double expected_area = 0.0;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const auto& curr = vertices[i].pos;
+    const auto& next = vertices[(i + 1) % num_vertices].pos;
+    expected_area += 0.5 * (curr.x() * next.y() - curr.y() * next.x());
+  }
+
+  EXPECT_NEAR(total_area, expected_area, 1.0e-9);
+}
+
 }  // namespace hydra
@@ -0,0 +1,190 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/occupancy_blocks.h>
+
+namespace hydra {
+
+namespace {
+
+hydra_msgs::OccupancyBlock makeBlock(const Eigen::Vector3i& index,
+                                     size_t voxels_per_side,
+                                     VoxelOccupancy value) {
+  hydra_msgs::OccupancyBlock block;
+  block.x = index.x();
+  block.y = index.y();
+  block.z = index.z();
+  block.states.resize(packedBlockSize(voxels_per_side), 0);
+  const size_t num_voxels = voxels_per_side * voxels_per_side * voxels_per_side;
+  for (size_t i = 0; i < num_voxels; ++i) {
+    packOccupancy(i, value, block.states);
+  }
+
+  return block;
+}
+
+hydra_msgs::OccupancyBlocks makeMsg(uint64_t sequence, bool full_update) {
+  hydra_msgs::OccupancyBlocks msg;
+  msg.voxel_size = 0.1;
+  msg.voxels_per_side = 4;
+  msg.sequence = sequence;
+  msg.full_update = full_update;
+  return msg;
+}
+
+}  // namespace
+
+TEST(OccupancyBlocks, PackUnpackRoundTrip) {
+  // 5^3 voxels don't fill the last byte, which should stay zero
+  const size_t vps = 5;
+  std::vector<uint8_t> states(packedBlockSize(vps), 0);
+  EXPECT_EQ(states.size(), 32u);
+
+  std::vector<VoxelOccupancy> expected;
+  for (size_t z = 0; z < vps; ++z) {
+    for (size_t y = 0; y < vps; ++y) {
+      for (size_t x = 0; x < vps; ++x) {
+        const auto value = static_cast<VoxelOccupancy>((x + 2 * y + z) % 3);
+        const auto index = packedVoxelIndex(vps, x, y, z);
+        EXPECT_EQ(index, expected.size());
+        packOccupancy(index, value, states);
+        expected.push_back(value);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(unpackOccupancy(states, i), expected[i]) << "voxel " << i;
+  }
+
+  EXPECT_EQ(states.back() & 0xfc, 0);
+
+  // overwriting a voxel leaves the others sharing its byte untouched
+  packOccupancy(5, VoxelOccupancy::OCCUPIED, states);
+  packOccupancy(5, VoxelOccupancy::UNKNOWN, states);
+  expected[5] = VoxelOccupancy::UNKNOWN;
+  for (size_t i = 4; i < 8; ++i) {
+    EXPECT_EQ(unpackOccupancy(states, i), expected[i]) << "voxel " << i;
+  }
+}
+
+TEST(OccupancyBlocks, ApplyAndErase) {
+  OccupancyBlockMap map;
+  EXPECT_EQ(map.getOccupancy(Eigen::Vector3f::Zero()), VoxelOccupancy::UNKNOWN);
+
+  // blocks on both sides of the origin (block size 0.4 m)
+  auto msg = makeMsg(1, true);
+  msg.blocks.push_back(makeBlock({0, 0, 0}, 4, VoxelOccupancy::FREE));
+  msg.blocks.push_back(makeBlock({-1, -1, -1}, 4, VoxelOccupancy::OCCUPIED));
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_TRUE(map.synchronized());
+  EXPECT_EQ(map.numBlocks(), 2u);
+  EXPECT_EQ(map.getOccupancy({0.05, 0.05, 0.05}), VoxelOccupancy::FREE);
+  EXPECT_EQ(map.getOccupancy({0.35, 0.35, 0.35}), VoxelOccupancy::FREE);
+  EXPECT_EQ(map.getOccupancy({-0.05, -0.05, -0.05}), VoxelOccupancy::OCCUPIED);
+  EXPECT_EQ(map.getOccupancy({-0.35, -0.35, -0.35}), VoxelOccupancy::OCCUPIED);
+  EXPECT_EQ(map.getOccupancy({-0.05, 0.05, 0.05}), VoxelOccupancy::UNKNOWN);
+  EXPECT_EQ(map.getOccupancy({0.45, 0.05, 0.05}), VoxelOccupancy::UNKNOWN);
+
+  // deltas replace changed blocks, add new ones and erase removed ones
+  msg = makeMsg(2, false);
+  auto changed = makeBlock({0, 0, 0}, 4, VoxelOccupancy::FREE);
+  packOccupancy(packedVoxelIndex(4, 1, 2, 3), VoxelOccupancy::OCCUPIED, changed.states);
+  msg.blocks.push_back(changed);
+  msg.blocks.push_back(makeBlock({1, 0, 0}, 4, VoxelOccupancy::OCCUPIED));
+  msg.removed = {-1, -1, -1};
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_EQ(map.numBlocks(), 2u);
+  EXPECT_EQ(map.getOccupancy({0.15, 0.25, 0.35}), VoxelOccupancy::OCCUPIED);
+  EXPECT_EQ(map.getOccupancy({0.05, 0.25, 0.35}), VoxelOccupancy::FREE);
+  EXPECT_EQ(map.getOccupancy({0.45, 0.05, 0.05}), VoxelOccupancy::OCCUPIED);
+  EXPECT_EQ(map.getOccupancy({-0.05, -0.05, -0.05}), VoxelOccupancy::UNKNOWN);
+
+  // blocks with the wrong size are dropped
+  msg = makeMsg(3, false);
+  msg.blocks.push_back(makeBlock({2, 0, 0}, 5, VoxelOccupancy::FREE));
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_EQ(map.numBlocks(), 2u);
+
+  // full updates replace everything
+  msg = makeMsg(4, true);
+  msg.blocks.push_back(makeBlock({0, 0, 1}, 4, VoxelOccupancy::FREE));
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_EQ(map.numBlocks(), 1u);
+  EXPECT_EQ(map.getOccupancy({0.05, 0.05, 0.05}), VoxelOccupancy::UNKNOWN);
+  EXPECT_EQ(map.getOccupancy({0.05, 0.05, 0.45}), VoxelOccupancy::FREE);
+
+  map.prune(Eigen::Vector3f(10.0, 0.0, 0.0), 1.0);
+  EXPECT_EQ(map.numBlocks(), 0u);
+}
+
+TEST(OccupancyBlocks, ResyncAfterGap) {
+  OccupancyBlockMap map;
+
+  // deltas without a full update first can't be applied
+  auto msg = makeMsg(3, false);
+  msg.blocks.push_back(makeBlock({0, 0, 0}, 4, VoxelOccupancy::FREE));
+  EXPECT_FALSE(map.update(msg));
+  EXPECT_FALSE(map.synchronized());
+  EXPECT_EQ(map.numBlocks(), 0u);
+
+  msg = makeMsg(4, true);
+  msg.blocks.push_back(makeBlock({0, 0, 0}, 4, VoxelOccupancy::FREE));
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_TRUE(map.synchronized());
+
+  // message 5 was lost, so the map is cleared until the next full update
+  msg = makeMsg(6, false);
+  msg.blocks.push_back(makeBlock({1, 0, 0}, 4, VoxelOccupancy::FREE));
+  EXPECT_FALSE(map.update(msg));
+  EXPECT_FALSE(map.synchronized());
+  EXPECT_EQ(map.numBlocks(), 0u);
+
+  msg = makeMsg(7, false);
+  EXPECT_FALSE(map.update(msg));
+
+  msg = makeMsg(8, true);
+  msg.blocks.push_back(makeBlock({1, 0, 0}, 4, VoxelOccupancy::FREE));
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_TRUE(map.synchronized());
+  EXPECT_EQ(map.numBlocks(), 1u);
+
+  msg = makeMsg(9, false);
+  msg.removed = {1, 0, 0};
+  EXPECT_TRUE(map.update(msg));
+  EXPECT_EQ(map.numBlocks(), 0u);
+}
+
+}  // namespace hydra
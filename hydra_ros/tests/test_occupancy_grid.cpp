@@ -0,0 +1,288 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/grid_utilities.h>
+#include <hydra_ros/utils/occupancy_publisher.h>
+#include <hydra_ros/utils/occupancy_tiles.h>
+
+#include <random>
+
+namespace hydra {
+
+namespace {
+
+OccupancyPublisher::Config getConfig(double slice_height, size_t num_slices) {
+  OccupancyPublisher::Config config;
+  config.use_relative_height = false;
+  config.slice_height = slice_height;
+  config.num_slices = num_slices;
+  config.min_distance = 0.3;
+  return config;
+}
+
+void fillBlock(TsdfLayer& layer, const BlockIndex& index, std::mt19937& rng) {
+  std::uniform_real_distribution<float> distance(-0.2f, 1.0f);
+  std::bernoulli_distribution observed(0.8);
+  auto& block = layer.allocateBlock(index);
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    auto& voxel = block.getVoxel(i);
+    voxel.distance = distance(rng);
+    voxel.weight = observed(rng) ? 1.0f : 0.0f;
+  }
+
+  block.updated = true;
+}
+
+void clearUpdated(TsdfLayer& layer) {
+  for (auto& block : layer) {
+    block.updated = false;
+  }
+}
+
+// rasterize every column of the layer from scratch into the extent of the grid
+std::vector<int8_t> rebuild(const OccupancyPublisher::Config& config,
+                            const TsdfLayer& layer,
+                            const IncrementalOccupancyGrid& grid) {
+  nav_msgs::OccupancyGrid msg;
+  msg.info.width = grid.grid().info.width;
+  msg.info.height = grid.grid().info.height;
+  msg.data.assign(msg.info.width * msg.info.height, -1);
+
+  const int vps = layer.voxels_per_side;
+  const int64_t slice_index = grid.sliceIndex();
+  const auto min_z = floorDiv(slice_index, vps);
+  const auto max_z = floorDiv(slice_index + config.num_slices - 1, vps);
+  spatial_hash::BlockIndexSet columns;
+  for (const auto& block : layer) {
+    if (block.index.z() >= min_z && block.index.z() <= max_z) {
+      columns.emplace(block.index.x(), block.index.y(), 0);
+    }
+  }
+
+  for (const auto& column : columns) {
+    fillOccupancyColumn(config,
+                        layer,
+                        Eigen::Isometry3f::Identity(),
+                        column,
+                        slice_index,
+                        false,
+                        grid.origin(),
+                        msg);
+  }
+
+  return msg.data;
+}
+
+// copy the changed regions of the grid into a copy of the previous grid
+void applyRegions(const IncrementalOccupancyGrid& grid, std::vector<int8_t>& data) {
+  const auto& msg = grid.grid();
+  for (const auto& region : grid.changedRegions()) {
+    for (int r = region.min.y(); r < region.max.y(); ++r) {
+      const auto offset = r * msg.info.width;
+      std::copy(msg.data.begin() + offset + region.min.x(),
+                msg.data.begin() + offset + region.max.x(),
+                data.begin() + offset + region.min.x());
+    }
+  }
+}
+
+}  // namespace
+
+TEST(OccupancyGrid, FloorDiv) {
+  EXPECT_EQ(floorDiv(0, 8), 0);
+  EXPECT_EQ(floorDiv(7, 8), 0);
+  EXPECT_EQ(floorDiv(8, 8), 1);
+  EXPECT_EQ(floorDiv(-1, 8), -1);
+  EXPECT_EQ(floorDiv(-8, 8), -1);
+  EXPECT_EQ(floorDiv(-9, 8), -2);
+}
+
+class IncrementalGridTest : public ::testing::TestWithParam<double> {};
+
+TEST_P(IncrementalGridTest, MatchesRebuild) {
+  // slices that straddle a block boundary and slices within a single block
+  const auto config = getConfig(GetParam(), 4);
+  const Eigen::Isometry3d world_T_sensor = Eigen::Isometry3d::Identity();
+  TsdfLayer layer(0.1, 8);
+  IncrementalOccupancyGrid grid(config);
+  std::mt19937 rng(12345);
+
+  const auto check = [&](const std::string& step) {
+    SCOPED_TRACE(step);
+    clearUpdated(layer);
+    EXPECT_EQ(grid.grid().data, rebuild(config, layer, grid));
+  };
+
+  // initial map around the origin, on both sides of every axis
+  for (int x = -2; x < 2; ++x) {
+    for (int y = -2; y < 2; ++y) {
+      for (int z = -1; z < 2; ++z) {
+        fillBlock(layer, BlockIndex(x, y, z), rng);
+      }
+    }
+  }
+
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 16u);
+  EXPECT_TRUE(grid.requiresFullGrid());
+  grid.clearRequiresFullGrid();
+  check("initial");
+
+  // blocks far outside the current extent (in the negative direction) grow the grid
+  fillBlock(layer, BlockIndex(-9, -1, 0), rng);
+  fillBlock(layer, BlockIndex(0, -7, 0), rng);
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 2u);
+  EXPECT_TRUE(grid.requiresFullGrid());
+  grid.clearRequiresFullGrid();
+  check("grow");
+
+  // updating existing blocks only changes their columns
+  auto previous = grid.grid().data;
+  fillBlock(layer, BlockIndex(1, 1, 0), rng);
+  fillBlock(layer, BlockIndex(-2, 0, 0), rng);
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 2u);
+  EXPECT_FALSE(grid.requiresFullGrid());
+  applyRegions(grid, previous);
+  EXPECT_EQ(grid.grid().data, previous);
+  check("update");
+
+  // removing blocks reverts their columns to unknown (the extent doesn't shrink)
+  previous = grid.grid().data;
+  layer.removeBlock(BlockIndex(-9, -1, 0));
+  layer.removeBlock(BlockIndex(0, -7, 0));
+  for (int z = -1; z < 2; ++z) {
+    layer.removeBlock(BlockIndex(1, 1, z));
+  }
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 0u);
+  EXPECT_FALSE(grid.requiresFullGrid());
+  applyRegions(grid, previous);
+  EXPECT_EQ(grid.grid().data, previous);
+  check("shrink");
+
+  // blocks outside of the slices don't contribute
+  fillBlock(layer, BlockIndex(0, 0, 5), rng);
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 0u);
+  check("outside slices");
+
+  // the grid starts over after a reset
+  grid.reset();
+  EXPECT_EQ(grid.update(world_T_sensor, layer), 15u);
+  check("reset");
+}
+
+INSTANTIATE_TEST_SUITE_P(SliceHeights,
+                         IncrementalGridTest,
+                         ::testing::Values(-0.15, 0.35));
+
+TEST(OccupancyGrid, RegionsAtNegativeIndices) {
+  const auto config = getConfig(0.05, 1);
+  TsdfLayer layer(0.1, 8);
+  IncrementalOccupancyGrid grid(config);
+  std::mt19937 rng(0);
+  fillBlock(layer, BlockIndex(-3, -2, 0), rng);
+  fillBlock(layer, BlockIndex(1, 1, 0), rng);
+  grid.update(Eigen::Isometry3d::Identity(), layer);
+  clearUpdated(layer);
+  EXPECT_EQ(grid.origin(), Eigen::Vector2i(-24, -16));
+  EXPECT_EQ(grid.grid().info.width, 40u);
+  EXPECT_EQ(grid.grid().info.height, 32u);
+  EXPECT_NEAR(grid.grid().info.origin.position.x, -2.4, 1.0e-6);
+  EXPECT_NEAR(grid.grid().info.origin.position.y, -1.6, 1.0e-6);
+
+  // neighboring columns in the same row of blocks merge into a single region
+  fillBlock(layer, BlockIndex(-3, -2, 0), rng);
+  fillBlock(layer, BlockIndex(-2, -2, 0), rng);
+  fillBlock(layer, BlockIndex(-3, -1, 0), rng);
+  grid.update(Eigen::Isometry3d::Identity(), layer);
+  const auto& regions = grid.changedRegions();
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0].min, Eigen::Vector2i(0, 0));
+  EXPECT_EQ(regions[0].max, Eigen::Vector2i(16, 8));
+  EXPECT_EQ(regions[1].min, Eigen::Vector2i(0, 8));
+  EXPECT_EQ(regions[1].max, Eigen::Vector2i(8, 16));
+}
+
+TEST(OccupancyGrid, TilesAtNegativeIndices) {
+  const auto config = getConfig(0.05, 1);
+  TsdfLayer layer(0.1, 8);
+  IncrementalOccupancyGrid grid(config);
+  std::mt19937 rng(0);
+  fillBlock(layer, BlockIndex(-1, -1, 0), rng);
+  fillBlock(layer, BlockIndex(0, 0, 0), rng);
+  grid.update(Eigen::Isometry3d::Identity(), layer);
+  clearUpdated(layer);
+
+  // cells [-8, 8) in both directions split into tiles [-2, 2) with 4 cell tiles
+  const auto tiles = getChangedTiles(grid, 4, 0, true);
+  ASSERT_EQ(tiles.size(), 16u);
+  EXPECT_EQ(tiles.front(), Eigen::Vector2i(-2, -2));
+  EXPECT_EQ(tiles.back(), Eigen::Vector2i(1, 1));
+
+  // only the tiles overlapping the updated block (cells [-8, 0)) are changed
+  fillBlock(layer, BlockIndex(-1, -1, 0), rng);
+  grid.update(Eigen::Isometry3d::Identity(), layer);
+  const std::vector<Eigen::Vector2i> expected{{-2, -2}, {-2, -1}, {-1, -2}, {-1, -1}};
+  EXPECT_EQ(getChangedTiles(grid, 4, 0), expected);
+
+  // coarser levels cover more cells per tile
+  const std::vector<Eigen::Vector2i> level1{{-1, -1}};
+  EXPECT_EQ(getChangedTiles(grid, 4, 1), level1);
+  const std::vector<Eigen::Vector2i> level2{{-1, -1}};
+  EXPECT_EQ(getChangedTiles(grid, 4, 2), level2);
+
+  // tile cells keep the maximum value of the grid cells they cover
+  nav_msgs::OccupancyGrid msg;
+  extractTile(grid, Eigen::Vector2i(-1, -1), 4, 1, msg);
+  EXPECT_NEAR(msg.info.origin.position.x, -0.8, 1.0e-6);
+  EXPECT_NEAR(msg.info.origin.position.y, -0.8, 1.0e-6);
+  EXPECT_NEAR(msg.info.resolution, 0.2, 1.0e-6);
+  ASSERT_EQ(msg.data.size(), 16u);
+  const auto& full = grid.grid();
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      int8_t expected_value = -1;
+      for (int i = 0; i < 4; ++i) {
+        const auto row = 2 * r + i / 2;
+        const auto col = 2 * c + i % 2;
+        const auto value = full.data[row * full.info.width + col];
+        expected_value = std::max(expected_value, value);
+      }
+
+      EXPECT_EQ(msg.data[r * 4 + c], expected_value)
+          << "cell (" << c << ", " << r << ")";
+    }
+  }
+}
+
+}  // namespace hydra